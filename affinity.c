@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include "defs.h"
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// memory policy constants from <numaif.h>, defined here so we don't need libnuma installed
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED  1
+#endif
+
+/*
+Function: int parseCpuList(const char *list, int ids[], int maxIds)
+Purpose: Reads the ids in a kernel cpu/node list string such as "0-1,4".
+in: list - Pointer to a null-terminated string in the kernel list format
+out: ids - Array the ids are written to, in the order they are listed
+in: maxIds - Number of ids the array holds, any more are left out
+return: Returns the number of ids written
+*/
+static int parseCpuList(const char *list, int ids[], int maxIds)
+{
+    int count = 0;
+    const char *p = list;
+    while (*p >= '0' && *p <= '9')
+    {
+        int first = (int)strtol(p, (char **)&p, 10);
+        int last = first;
+        if (*p == '-')
+        {
+            p++;
+            last = (int)strtol(p, (char **)&p, 10);
+        }
+        for (int id = first; id <= last && count < maxIds; id++)
+        {
+            ids[count++] = id;
+        }
+        if (*p != ',')
+        {
+            break;
+        }
+        p++;
+    }
+    return count;
+}
+
+/*
+Function: void initPlacement(PlacementType *placement, int enabled)
+Purpose: Detects the cores the process is allowed to run on, which taskset or a cgroup cpuset may narrow, and the
+         NUMA nodes of the machine.
+in/out: placement - Pointer to the PlacementType structure to be initialized
+in: enabled - C_TRUE if simulation threads should be pinned to cores
+return: none
+*/
+void initPlacement(PlacementType *placement, int enabled)
+{
+    placement->enabled = enabled;
+    placement->numCores = 0;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE && placement->numCores < MAX_CORES; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                placement->cores[placement->numCores++] = cpu;
+            }
+        }
+    }
+    if (placement->numCores == 0)
+    {
+        // without the mask, fall back on every online cpu
+        int online = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        for (int cpu = 0; cpu < online && cpu < MAX_CORES; cpu++)
+        {
+            placement->cores[placement->numCores++] = cpu;
+        }
+    }
+    if (placement->numCores == 0)
+    {
+        placement->cores[placement->numCores++] = 0;
+    }
+
+    // a missing sysfs node directory means the kernel has no NUMA support, treat it as node 0 alone
+    placement->numNodes = 0;
+    FILE *file = fopen("/sys/devices/system/node/online", "r");
+    if (file != NULL)
+    {
+        char buffer[MAX_STR];
+        if (fgets(buffer, MAX_STR, file) != NULL)
+        {
+            placement->numNodes = parseCpuList(buffer, placement->nodes, MAX_NODES);
+        }
+        fclose(file);
+    }
+    if (placement->numNodes == 0)
+    {
+        placement->nodes[placement->numNodes++] = 0;
+    }
+}
+
+/*
+Function: int placesMemory(PlacementType *placement)
+Purpose: Tells whether memory is put on NUMA nodes, which only happens when pinning and there is more than one node.
+in: placement - Pointer to the PlacementType structure describing the machine
+return: Returns C_TRUE if memory should come from allocOnNode
+*/
+int placesMemory(PlacementType *placement)
+{
+    return placement->enabled && placement->numNodes > 1;
+}
+
+/*
+Function: int getCoreNode(PlacementType *placement, int core)
+Purpose: Finds the NUMA node that a core belongs to.
+in: placement - Pointer to the PlacementType structure describing the machine
+in: core - Id of the core
+return: Returns the id of the node of the core, the first node if it can't be determined
+*/
+int getCoreNode(PlacementType *placement, int core)
+{
+    if (placement->numNodes <= 1)
+    {
+        return placement->nodes[0];
+    }
+
+    char path[MAX_STR * 2];
+    for (int i = 0; i < placement->numNodes; i++)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", core, placement->nodes[i]);
+        if (access(path, F_OK) == 0)
+        {
+            return placement->nodes[i];
+        }
+    }
+    return placement->nodes[0];
+}
+
+/*
+Function: int getWorkerCore(PlacementType *placement, int worker)
+Purpose: Picks the core for a simulation thread, worker 0 being the ghost and the hunters following it.
+in: placement - Pointer to the PlacementType structure describing the machine
+in: worker - Index of the simulation thread
+return: Returns the id of the core the thread should run on, one the process is allowed to use
+*/
+int getWorkerCore(PlacementType *placement, int worker)
+{
+    return placement->cores[worker % placement->numCores];
+}
+
+/*
+Function: int createPinnedThread(PlacementType *placement, pthread_t *thread, int core, void *(*start)(void *), void *arg)
+Purpose: Starts a thread that runs only on the given core from its first instruction, by setting the affinity in its
+         attributes before it is created. With pinning disabled the thread is started unpinned.
+in: placement - Pointer to the PlacementType structure describing the machine
+out: thread - The thread started
+in: core - Id of the core
+in: start - The function the thread runs
+in: arg - The argument it is given
+return: Returns 0 if the thread is pinned, -1 if it runs unpinned
+*/
+int createPinnedThread(PlacementType *placement, pthread_t *thread, int core, void *(*start)(void *), void *arg)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    int pinned = C_FALSE;
+    if (placement->enabled)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pinned = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set) == 0;
+    }
+    int error = pthread_create(thread, &attr, start, arg);
+    if (error != 0 && pinned)
+    {
+        // the core may have been taken away since it was read, run the thread wherever it is allowed to
+        printf("Error: Failed to pin thread to core %d\n", core);
+        pinned = C_FALSE;
+        error = pthread_create(thread, NULL, start, arg);
+    }
+    pthread_attr_destroy(&attr);
+    if (error != 0)
+    {
+        printf("Error: Failed to create thread\n");
+        exit(1);
+    }
+    return pinned ? 0 : -1;
+}
+
+/*
+Function: void *allocOnNode(PlacementType *placement, size_t size, int node)
+Purpose: Allocates zeroed, page aligned memory that prefers the given NUMA node.
+in: placement - Pointer to the PlacementType structure describing the machine
+in: size - Number of bytes to allocate
+in: node - The node the memory should live on
+return: Returns a pointer to the memory, must be released with freeOnNode
+*/
+void *allocOnNode(PlacementType *placement, size_t size, int node)
+{
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        printf("Error allocating memory on node %d\n", node);
+        exit(1);
+    }
+
+    // the policy has to be set before the pages are first touched, memory that can't be bound still works
+    if (placesMemory(placement))
+    {
+        // the kernel reads one bit less than the mask length it is given
+        unsigned long mask = 0;
+        if (node >= 0 && node < (int)sizeof(mask) * 8 - 1)
+        {
+            mask = 1UL << node;
+        }
+        if (mask == 0)
+        {
+            printf("Error: Node %d is out of range for binding memory\n", node);
+        }
+        else if (syscall(SYS_mbind, memory, size, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0) != 0)
+        {
+            printf("Error: Failed to bind memory to node %d: %s\n", node, strerror(errno));
+        }
+    }
+    return memory;
+}
+
+/*
+Function: void freeOnNode(void *memory, size_t size)
+Purpose: Releases memory allocated by allocOnNode.
+in/out: memory - Pointer to the memory to be freed
+in: size - Number of bytes that were allocated
+return: none
+*/
+void freeOnNode(void *memory, size_t size)
+{
+    if (memory != NULL)
+    {
+        munmap(memory, size);
+    }
+}
+
+/*
+Function: void *moveToNode(PlacementType *placement, void *memory, size_t size, int node)
+Purpose: Moves memory that came from the heap into memory from allocOnNode on the given node. Only the heap's own
+         allocation is let go, no other allocation that shares its pages is touched.
+in: placement - Pointer to the PlacementType structure describing the machine
+in/out: memory - Pointer to the heap memory, it is freed
+in: size - Number of bytes to move
+in: node - The node the memory should live on
+return: Returns a pointer to the moved memory, must be released with freeOnNode
+*/
+void *moveToNode(PlacementType *placement, void *memory, size_t size, int node)
+{
+    void *placed = allocOnNode(placement, size, node);
+    memcpy(placed, memory, size);
+    free(memory);
+    return placed;
+}
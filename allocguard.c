@@ -0,0 +1,68 @@
+#include "defs.h"
+
+/*
+Counts heap allocations by the phase of the thread making them. A normal build only tracks the phase,
+built with -DALLOC_GUARD (make -f Makefile.txt guard) malloc, calloc and realloc are replaced by
+counting wrappers around glibc's own allocator.
+*/
+
+static __thread AllocPhase allocPhase = PHASE_SETUP;
+
+/*
+Function: void setAllocPhase(AllocPhase phase)
+Purpose: Marks which phase the calling thread is in, allocations are counted against it.
+in: phase - The phase the thread is entering
+return: none
+*/
+void setAllocPhase(AllocPhase phase)
+{
+    allocPhase = phase;
+}
+
+#ifdef ALLOC_GUARD
+static long allocations[PHASE_COUNT];
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *memory, size_t size);
+
+void *malloc(size_t size)
+{
+    __atomic_fetch_add(&allocations[allocPhase], 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    __atomic_fetch_add(&allocations[allocPhase], 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *memory, size_t size)
+{
+    __atomic_fetch_add(&allocations[allocPhase], 1, __ATOMIC_RELAXED);
+    return __libc_realloc(memory, size);
+}
+#endif
+
+/*
+Function: int checkAllocations()
+Purpose: Prints the allocations made in each phase when built with ALLOC_GUARD.
+return: Returns -1 if the ghost or hunters allocated while playing, 0 otherwise
+*/
+int checkAllocations()
+{
+#ifdef ALLOC_GUARD
+    printf("\nAllocations by phase\n");
+    printf("=================================\n");
+    printf("Setup:    %ld\n", allocations[PHASE_SETUP]);
+    printf("Run:      %ld\n", allocations[PHASE_RUN]);
+    printf("Teardown: %ld\n", allocations[PHASE_TEARDOWN]);
+    if (allocations[PHASE_RUN] > 0)
+    {
+        printf("Error: The game loop allocated memory %ld times\n", allocations[PHASE_RUN]);
+        return -1;
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,678 @@
+#include "defs.h"
+
+// how hunters were laid out before their hot state was given its own cache line, kept to compare against
+typedef struct PackedHunter {
+    int id;
+    int slot;
+    char name[MAX_STR];
+    EvidenceType equipment;
+    EvidenceArrayType *evidenceArray;
+    int fear;
+    int boredom;
+    RoomType *room;
+    pthread_t thread;
+    unsigned char *visited;
+} PackedHunterType;
+
+// one benchmark thread, the hunters of every thread sit next to each other in one array
+typedef struct ScalingWorker {
+    pthread_t thread;
+    int packed;
+    PackedHunterType *packedHunter;
+    HunterType *hunter;
+    RoomType *rooms[2];
+    int *running;
+    long updates;
+} ScalingWorkerType;
+
+/*
+Function: void *scalingWorker(void *param)
+Purpose: Makes the writes of a hunter update to one hunter, as fast as it can, until told to stop.
+in/out: param - Pointer to the ScalingWorkerType structure of the thread, its update count is set
+return: none
+*/
+static void *scalingWorker(void *param)
+{
+    ScalingWorkerType *worker = (ScalingWorkerType *)param;
+    long updates = 0;
+
+    // the same fields a hunter's move reads and writes in both layouts, volatile so every update reaches memory
+    if (worker->packed)
+    {
+        volatile PackedHunterType *hunter = worker->packedHunter;
+        while (__atomic_load_n(worker->running, __ATOMIC_RELAXED))
+        {
+            if (hunter->room == worker->rooms[0] && hunter->equipment != EV_UNKNOWN)
+            {
+                hunter->fear = (hunter->fear + 1) % FEAR_MAX;
+                hunter->boredom = 0;
+            }
+            else
+            {
+                hunter->boredom = (hunter->boredom + 1) % BOREDOM_MAX;
+            }
+            hunter->room = worker->rooms[updates & 1];
+            hunter->slot = (int)(updates & 3);
+            updates++;
+        }
+    }
+    else
+    {
+        volatile HunterType *hunter = worker->hunter;
+        while (__atomic_load_n(worker->running, __ATOMIC_RELAXED))
+        {
+            if (hunter->room == worker->rooms[0] && hunter->equipment != EV_UNKNOWN)
+            {
+                hunter->fear = (hunter->fear + 1) % FEAR_MAX;
+                hunter->boredom = 0;
+            }
+            else
+            {
+                hunter->boredom = (hunter->boredom + 1) % BOREDOM_MAX;
+            }
+            hunter->room = worker->rooms[updates & 1];
+            hunter->slot = (int)(updates & 3);
+            updates++;
+        }
+    }
+
+    worker->updates = updates;
+    return NULL;
+}
+
+/*
+Function: double measureScaling(PlacementType *placement, int numThreads, int packed, RoomType *rooms[])
+Purpose: Runs numThreads hunter threads for SCALING_DURATION microseconds and measures their combined update rate.
+in: placement - Pointer to the PlacementType structure, threads are pinned when it is enabled
+in: numThreads - Number of hunter threads
+in: packed - C_TRUE for the old packed layout, C_FALSE for HunterType
+in: rooms - Array of the two rooms the hunters move between
+return: Returns the updates per second over all threads
+*/
+static double measureScaling(PlacementType *placement, int numThreads, int packed, RoomType *rooms[])
+{
+    PackedHunterType *packedHunters = calloc(numThreads, sizeof(PackedHunterType));
+    HunterType *hunters = aligned_alloc(CACHE_LINE, numThreads * sizeof(HunterType));
+    ScalingWorkerType *workers = calloc(numThreads, sizeof(ScalingWorkerType));
+    if (packedHunters == NULL || hunters == NULL || workers == NULL)
+    {
+        printf("Error allocating memory for scaling benchmark\n");
+        exit(1);
+    }
+
+    int running = C_TRUE;
+    for (int i = 0; i < numThreads; i++)
+    {
+        initHunter(&hunters[i], i, "Hunter", (EvidenceType)(i % EV_COUNT), rooms[0]);
+        packedHunters[i].id = i;
+        packedHunters[i].equipment = (EvidenceType)(i % EV_COUNT);
+        packedHunters[i].room = rooms[0];
+
+        workers[i].packed = packed;
+        workers[i].packedHunter = &packedHunters[i];
+        workers[i].hunter = &hunters[i];
+        workers[i].rooms[0] = rooms[0];
+        workers[i].rooms[1] = rooms[1];
+        workers[i].running = &running;
+        createPinnedThread(placement, &workers[i].thread, getWorkerCore(placement, i), scalingWorker, &workers[i]);
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    usleep(SCALING_DURATION);
+    __atomic_store_n(&running, C_FALSE, __ATOMIC_RELAXED);
+
+    long updates = 0;
+    for (int i = 0; i < numThreads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        updates += workers[i].updates;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    free(packedHunters);
+    free(hunters);
+    free(workers);
+    return updates / ((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+}
+
+/*
+Function: void runScalingBenchmark(PlacementType *placement)
+Purpose: Prints the hunter update rate from 1 to SCALING_MAX_THREADS threads, with hunters packed next to each
+         other and with each hunter's hot state on its own cache line.
+in: placement - Pointer to the PlacementType structure, threads are pinned when it is enabled
+return: none
+*/
+void runScalingBenchmark(PlacementType *placement)
+{
+    RoomType *rooms[2];
+    rooms[0] = createRoom("Van");
+    rooms[1] = createRoom("Hallway");
+
+    printf("Hunter updates per second (%d cores, %zu byte packed hunters, %zu byte aligned hunters)\n",
+           placement->numCores, sizeof(PackedHunterType), sizeof(HunterType));
+    printf("=================================\n");
+    printf("Threads       Packed      Aligned   Speedup\n");
+    for (int numThreads = 1; numThreads <= SCALING_MAX_THREADS; numThreads *= 2)
+    {
+        double packed = measureScaling(placement, numThreads, C_TRUE, rooms);
+        double aligned = measureScaling(placement, numThreads, C_FALSE, rooms);
+        printf("%7d %12.0f %12.0f %8.2fx\n", numThreads, packed, aligned, aligned / packed);
+    }
+
+    freeRoom(rooms[0]);
+    freeRoom(rooms[1]);
+}
+
+// how the ghost read benchmark's threads share the ghost
+enum GhostReadMode { READ_UNLOCKED, READ_LOCKED, READ_SEQLOCK };
+
+// one thread of the ghost read benchmark, the ghost's own thread if it has no reader to count for
+typedef struct GhostReadWorker {
+    pthread_t thread;
+    GhostType *ghost;
+    RoomType **rooms;
+    int numRooms;
+    enum GhostReadMode mode;
+    //the one lock every thread takes in READ_LOCKED
+    sem_t *lock;
+    sem_t *start;
+    int *running;
+    long reads;
+    long torn;
+} GhostReadWorkerType;
+
+/*
+Function: void *ghostWriter(void *param)
+Purpose: Moves the ghost from room to room as fast as it can until told to stop, always with its boredom set to
+         the id of the room it is in, so a reader can tell a copy that mixes two moves.
+in/out: param - Pointer to the GhostReadWorkerType structure of the writer
+return: none
+*/
+static void *ghostWriter(void *param)
+{
+    GhostReadWorkerType *writer = (GhostReadWorkerType *)param;
+    long moves = 0;
+    sem_wait(writer->start);
+    while (__atomic_load_n(writer->running, __ATOMIC_RELAXED))
+    {
+        RoomType *room = writer->rooms[moves % writer->numRooms];
+        if (writer->mode == READ_LOCKED)
+        {
+            sem_wait(writer->lock);
+        }
+        publishGhost(writer->ghost, room, room->id);
+        if (writer->mode == READ_LOCKED)
+        {
+            sem_post(writer->lock);
+        }
+        moves++;
+    }
+    writer->reads = moves;
+    return NULL;
+}
+
+/*
+Function: void *ghostReader(void *param)
+Purpose: Reads the ghost as a hunter would as fast as it can until told to stop, counting the copies whose room
+         and boredom come from different moves. Unlocked, the fields are read one by one as they used to be.
+in/out: param - Pointer to the GhostReadWorkerType structure of the reader, its counts are set
+return: none
+*/
+static void *ghostReader(void *param)
+{
+    GhostReadWorkerType *reader = (GhostReadWorkerType *)param;
+    long reads = 0;
+    long torn = 0;
+    GhostViewType view;
+    sem_wait(reader->start);
+    while (__atomic_load_n(reader->running, __ATOMIC_RELAXED))
+    {
+        if (reader->mode == READ_SEQLOCK)
+        {
+            readGhost(reader->ghost, &view);
+        }
+        else
+        {
+            if (reader->mode == READ_LOCKED)
+            {
+                sem_wait(reader->lock);
+            }
+            view.room = __atomic_load_n(&reader->ghost->room, __ATOMIC_RELAXED);
+            view.boredomTime = __atomic_load_n(&reader->ghost->boredomTime, __ATOMIC_RELAXED);
+            if (reader->mode == READ_LOCKED)
+            {
+                sem_post(reader->lock);
+            }
+        }
+        torn += view.boredomTime != view.room->id;
+        reads++;
+    }
+    reader->reads = reads;
+    reader->torn = torn;
+    return NULL;
+}
+
+/*
+Function: double measureGhostReads(PlacementType *placement, int numReaders, enum GhostReadMode mode, RoomType *rooms[], int numRooms, long *torn)
+Purpose: Runs one ghost thread moving the ghost and numReaders threads reading it for SCALING_DURATION microseconds.
+in: placement - Pointer to the PlacementType structure, threads are pinned when it is enabled
+in: numReaders - Number of reading threads
+in: mode - How the threads share the ghost
+in: rooms - Array of the rooms the ghost moves between, each with its own id
+in: numRooms - Number of rooms
+out: torn - Number of reads that mixed two moves
+return: Returns the reads per second over all readers
+*/
+static double measureGhostReads(PlacementType *placement, int numReaders, enum GhostReadMode mode, RoomType *rooms[], int numRooms, long *torn)
+{
+    GhostReadWorkerType *workers = calloc(numReaders + 1, sizeof(GhostReadWorkerType));
+    GhostType *ghost = aligned_alloc(CACHE_LINE, CACHE_LINE);
+    if (workers == NULL || ghost == NULL)
+    {
+        printf("Error allocating memory for ghost read benchmark\n");
+        exit(1);
+    }
+    ghost->ghostType = POLTERGEIST;
+    ghost->room = rooms[0];
+    ghost->boredomTime = rooms[0]->id;
+    ghost->version = 0;
+
+    // every thread is made before any of them starts, so the slow starts of a thousand threads aren't timed
+    sem_t start;
+    sem_t lock;
+    sem_init(&start, 0, 0);
+    sem_init(&lock, 0, 1);
+    int running = C_TRUE;
+    for (int i = 0; i <= numReaders; i++)
+    {
+        workers[i].ghost = ghost;
+        workers[i].rooms = rooms;
+        workers[i].numRooms = numRooms;
+        workers[i].mode = mode;
+        workers[i].lock = &lock;
+        workers[i].start = &start;
+        workers[i].running = &running;
+        createPinnedThread(placement, &workers[i].thread, getWorkerCore(placement, i), i == 0 ? ghostWriter : ghostReader, &workers[i]);
+    }
+
+    struct timespec begin;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i <= numReaders; i++)
+    {
+        sem_post(&start);
+    }
+    usleep(SCALING_DURATION);
+    __atomic_store_n(&running, C_FALSE, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long reads = 0;
+    *torn = 0;
+    for (int i = 0; i <= numReaders; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        if (i > 0)
+        {
+            reads += workers[i].reads;
+            *torn += workers[i].torn;
+        }
+    }
+    sem_destroy(&start);
+    sem_destroy(&lock);
+
+    free(ghost);
+    free(workers);
+    return reads / ((end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9);
+}
+
+/*
+Function: void runGhostReadBenchmark(PlacementType *placement)
+Purpose: Prints how fast 1 to GHOST_READERS_MAX hunter threads can read the ghost while it moves, reading the
+         fields one by one as they used to, under one lock shared with the ghost and through the seqlock, and how
+         many reads of each mixed two moves.
+in: placement - Pointer to the PlacementType structure, threads are pinned when it is enabled
+return: none
+*/
+void runGhostReadBenchmark(PlacementType *placement)
+{
+    RoomType *rooms[4];
+    const char *names[4] = { "Van", "Hallway", "Kitchen", "Basement" };
+    for (int i = 0; i < 4; i++)
+    {
+        rooms[i] = createRoom(names[i]);
+        rooms[i]->id = i;
+    }
+
+    printf("Ghost reads per second while it moves (%d cores)\n", placement->numCores);
+    printf("=================================\n");
+    printf("Readers     Unlocked     Torn       Locked     Torn      Seqlock     Torn\n");
+    for (int numReaders = 1; numReaders <= GHOST_READERS_MAX; numReaders *= 10)
+    {
+        long tornUnlocked;
+        long tornLocked;
+        long tornSeqlock;
+        double unlocked = measureGhostReads(placement, numReaders, READ_UNLOCKED, rooms, 4, &tornUnlocked);
+        double locked = measureGhostReads(placement, numReaders, READ_LOCKED, rooms, 4, &tornLocked);
+        double seqlock = measureGhostReads(placement, numReaders, READ_SEQLOCK, rooms, 4, &tornSeqlock);
+        printf("%7d %12.0f %8ld %12.0f %8ld %12.0f %8ld\n", numReaders, unlocked, tornUnlocked, locked, tornLocked, seqlock, tornSeqlock);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        freeRoom(rooms[i]);
+    }
+}
+
+// how the doorway benchmark's hunters cross
+enum DoorwayMode { CROSS_TWO_STEPS, CROSS_SAME_SHARD, CROSS_OTHER_SHARD };
+
+// one hunter of the doorway benchmark, walking back and forth between the two rooms
+typedef struct DoorwayWorker {
+    pthread_t thread;
+    HunterType *hunter;
+    //every hunter of the benchmark by id
+    HunterType *allHunters;
+    RoomType *rooms[2];
+    enum DoorwayMode mode;
+    sem_t *start;
+    int *running;
+    long moves;
+} DoorwayWorkerType;
+
+/*
+Function: void *doorwayWorker(void *param)
+Purpose: Moves a hunter through the doorway as fast as it can until told to stop. In two steps it leaves one room
+         and then enters the other, as hunters used to.
+in/out: param - Pointer to the DoorwayWorkerType structure of the hunter, its move count is set
+return: none
+*/
+static void *doorwayWorker(void *param)
+{
+    DoorwayWorkerType *worker = (DoorwayWorkerType *)param;
+    HunterType *hunter = worker->hunter;
+    long moves = 0;
+    sem_wait(worker->start);
+    while (__atomic_load_n(worker->running, __ATOMIC_RELAXED))
+    {
+        RoomType *to = hunter->room == worker->rooms[0] ? worker->rooms[1] : worker->rooms[0];
+        if (worker->mode == CROSS_TWO_STEPS)
+        {
+            removeOccupant(hunter, worker->allHunters);
+            hunter->room = to;
+            addOccupant(to, hunter);
+        }
+        else
+        {
+            moveOccupant(hunter, to, worker->allHunters);
+        }
+        moves++;
+    }
+    worker->moves = moves;
+    return NULL;
+}
+
+/*
+Function: int occupantsAgree(RoomType *room, HunterType *hunters)
+Purpose: Checks that a room's list of hunter ids matches its count and that each hunter in it knows its slot.
+in: room - Pointer to the RoomType structure, no hunter is moving
+in: hunters - Array of the hunters by id
+return: Returns C_TRUE if the list, the count and the slots agree
+*/
+static int occupantsAgree(RoomType *room, HunterType *hunters)
+{
+    if (room->numOccupants != countOccupants(room))
+    {
+        return C_FALSE;
+    }
+    for (int slot = 0; slot < room->numOccupants; slot++)
+    {
+        HunterType *hunter = &hunters[room->occupants[slot]];
+        if (hunter->room != room || hunter->slot != slot)
+        {
+            return C_FALSE;
+        }
+    }
+    return C_TRUE;
+}
+
+/*
+Function: double measureDoorway(PlacementType *placement, int numHunters, enum DoorwayMode mode, long *looks, long *miscounts, int *listsAgree)
+Purpose: Runs numHunters hunter threads crossing one doorway for SCALING_DURATION microseconds while this thread
+         keeps counting the hunters on both sides of it.
+in: placement - Pointer to the PlacementType structure, threads are pinned when it is enabled
+in: numHunters - Number of hunter threads
+in: mode - How the hunters cross
+out: looks - Number of times both sides were counted
+out: miscounts - Number of those counts that didn't add up to numHunters
+out: listsAgree - C_TRUE if both rooms' hunter ids matched their counts once the hunters stopped
+return: Returns the moves per second over all hunters
+*/
+static double measureDoorway(PlacementType *placement, int numHunters, enum DoorwayMode mode, long *looks, long *miscounts, int *listsAgree)
+{
+    // two shards' worth of rooms, the doorway is between two rooms of the first or one of each
+    HouseType house;
+    initHouse(&house);
+    seedRandom(1);
+    generateRooms(&house, 2 * OCCUPANCY_ROOMS);
+    createOccupancy(&house, numHunters);
+    RoomType *rooms[2] = { house.index->rooms[1], house.index->rooms[mode == CROSS_OTHER_SHARD ? OCCUPANCY_ROOMS + 1 : 2] };
+
+    HunterType *hunters = aligned_alloc(CACHE_LINE, numHunters * sizeof(HunterType));
+    DoorwayWorkerType *workers = calloc(numHunters, sizeof(DoorwayWorkerType));
+    if (hunters == NULL || workers == NULL)
+    {
+        printf("Error allocating memory for doorway benchmark\n");
+        exit(1);
+    }
+
+    sem_t start;
+    sem_init(&start, 0, 0);
+    int running = C_TRUE;
+    for (int i = 0; i < numHunters; i++)
+    {
+        initHunter(&hunters[i], i, "Hunter", (EvidenceType)(i % EV_COUNT), rooms[i % 2]);
+        addOccupant(rooms[i % 2], &hunters[i]);
+        workers[i].hunter = &hunters[i];
+        workers[i].allHunters = hunters;
+        workers[i].rooms[0] = rooms[0];
+        workers[i].rooms[1] = rooms[1];
+        workers[i].mode = mode;
+        workers[i].start = &start;
+        workers[i].running = &running;
+        createPinnedThread(placement, &workers[i].thread, getWorkerCore(placement, i + 1), doorwayWorker, &workers[i]);
+    }
+
+    struct timespec begin;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int i = 0; i < numHunters; i++)
+    {
+        sem_post(&start);
+    }
+    *looks = 0;
+    *miscounts = 0;
+    do
+    {
+        int count1;
+        int count2;
+        readOccupants(rooms[0], rooms[1], &count1, &count2);
+        *miscounts += count1 + count2 != numHunters;
+        (*looks)++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - begin.tv_sec) * 1000000L + (now.tv_nsec - begin.tv_nsec) / 1000 < SCALING_DURATION);
+    __atomic_store_n(&running, C_FALSE, __ATOMIC_RELAXED);
+
+    long moves = 0;
+    for (int i = 0; i < numHunters; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        moves += workers[i].moves;
+    }
+    sem_destroy(&start);
+    *listsAgree = occupantsAgree(rooms[0], hunters) && occupantsAgree(rooms[1], hunters);
+
+    free(hunters);
+    free(workers);
+    freeHouse(&house);
+    return moves / ((now.tv_sec - begin.tv_sec) + (now.tv_nsec - begin.tv_nsec) / 1e9);
+}
+
+/*
+Function: void runDoorwayBenchmark(PlacementType *placement)
+Purpose: Prints how fast 1 to DOORWAY_MAX_HUNTERS hunter threads can cross one doorway, leaving and entering in two
+         steps as they used to, moving between rooms of one occupancy shard and moving between two shards, and how
+         often a watcher counting both rooms saw the wrong total. Once the hunters stop, each room's hunter ids are
+         checked against its count.
+in: placement - Pointer to the PlacementType structure, threads are pinned when it is enabled
+return: none
+*/
+void runDoorwayBenchmark(PlacementType *placement)
+{
+    static const char *modeNames[3] = { "Two steps", "One shard", "Two shards" };
+    printf("Hunter moves per second through one doorway (%d cores)\n", placement->numCores);
+    printf("=================================\n");
+    printf("%-11s %7s %12s %10s %10s %5s\n", "Crossing", "Hunters", "Moves/s", "Looks", "Miscounts", "Ids");
+    for (int mode = CROSS_TWO_STEPS; mode <= CROSS_OTHER_SHARD; mode++)
+    {
+        for (int numHunters = 1; numHunters <= DOORWAY_MAX_HUNTERS; numHunters *= 4)
+        {
+            long looks;
+            long miscounts;
+            int listsAgree;
+            double moves = measureDoorway(placement, numHunters, (enum DoorwayMode)mode, &looks, &miscounts, &listsAgree);
+            printf("%-11s %7d %12.0f %10ld %10ld %5s\n", modeNames[mode], numHunters, moves, looks, miscounts, listsAgree ? "ok" : "wrong");
+        }
+    }
+}
+
+/*
+Function: int walkEvidence(EvidenceListType *evidenceList, EvidenceType evidence, long now)
+Purpose: Checks a room's evidence list for a type the slow way, looking at every piece and dropping nothing, so it
+         sees what the index should say without changing the list.
+in: evidenceList - Pointer to the EvidenceListType structure of the room
+in: evidence - The type of evidence
+in: now - The current virtual time in ghost updates
+return: Returns C_TRUE if the room holds that evidence and it hasn't faded
+*/
+static int walkEvidence(EvidenceListType *evidenceList, EvidenceType evidence, long now)
+{
+    if (evidenceList->fadeTime > 0)
+    {
+        for (int i = 0; i < evidenceList->count; i++)
+        {
+            EvidenceEntryType *entry = &evidenceList->ring[(evidenceList->start + i) % EVIDENCE_RING_SIZE];
+            if (entry->evidence == evidence && entry->expires > now)
+            {
+                return C_TRUE;
+            }
+        }
+        return C_FALSE;
+    }
+    for (EvidenceNodeType *node = evidenceList->ehead; node != NULL; node = node->next)
+    {
+        if (node->evidence == evidence)
+        {
+            return C_TRUE;
+        }
+    }
+    return C_FALSE;
+}
+
+/*
+Function: void measureEvidenceIndex(long fadeTime, long *checks, long *mismatches, double *indexTime, double *walkTime)
+Purpose: Has a ghost wander a generated house for EVIDENCE_CHECK_UPDATES updates, leaving evidence and having some of
+         it picked up, and after every update asks the evidence index which rooms hold a random type and checks the
+         answer against a walk over every room's list.
+in: fadeTime - Ghost updates evidence lasts for, 0 for unbounded lists
+out: checks - Number of times the index was checked
+out: mismatches - Number of those where the index and the walk disagreed
+out: indexTime - Nanoseconds per check spent asking the index
+out: walkTime - Nanoseconds per check spent walking the rooms
+return: none
+*/
+static void measureEvidenceIndex(long fadeTime, long *checks, long *mismatches, double *indexTime, double *walkTime)
+{
+    HouseType house;
+    initHouse(&house);
+    seedRandom(1);
+    generateRooms(&house, EVIDENCE_CHECK_ROOMS);
+    int numRooms = house.index->numRooms;
+    house.evidenceIndex = createEvidenceIndex(numRooms);
+    for (int i = 0; i < numRooms; i++)
+    {
+        attachEvidenceIndex(house.index->rooms[i]->evidencelist, house.evidenceIndex, i);
+        setEvidenceFadeTime(house.index->rooms[i]->evidencelist, fadeTime);
+    }
+    GhostType ghost;
+    ghost.ghostType = POLTERGEIST;
+    ghost.room = house.index->rooms[1];
+    ghost.boredomTime = 0;
+    ghost.version = 0;
+    ghost.dropped = 0;
+
+    *checks = 0;
+    *mismatches = 0;
+    long indexNs = 0;
+    long walkNs = 0;
+    struct timespec before;
+    struct timespec after;
+    for (long now = 1; now <= EVIDENCE_CHECK_UPDATES; now++)
+    {
+        moveToRandomRoomGhost(&ghost);
+        addEvidence(&ghost, now);
+        if (randInt(0, 4) == 0)
+        {
+            takeEvidence(house.index->rooms[randInt(0, numRooms)], (EvidenceType)randInt(0, EV_COUNT), now);
+        }
+
+        EvidenceType evidence = (EvidenceType)randInt(0, EV_COUNT);
+        int room = randInt(0, numRooms);
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        int indexed = countRoomsWithEvidence(house.evidenceIndex, evidence, now);
+        int indexedRoom = hasEvidence(house.evidenceIndex, room, evidence, now);
+        clock_gettime(CLOCK_MONOTONIC, &after);
+        indexNs += (after.tv_sec - before.tv_sec) * 1000000000L + (after.tv_nsec - before.tv_nsec);
+
+        int walked = 0;
+        for (int i = 0; i < numRooms; i++)
+        {
+            walked += walkEvidence(house.index->rooms[i]->evidencelist, evidence, now);
+        }
+        int walkedRoom = walkEvidence(house.index->rooms[room]->evidencelist, evidence, now);
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        walkNs += (before.tv_sec - after.tv_sec) * 1000000000L + (before.tv_nsec - after.tv_nsec);
+
+        *mismatches += indexed != walked || indexedRoom != walkedRoom;
+        (*checks)++;
+    }
+    *indexTime = (double)indexNs / *checks;
+    *walkTime = (double)walkNs / *checks;
+    freeHouse(&house);
+}
+
+/*
+Function: void runEvidenceIndexBenchmark()
+Purpose: Prints how long asking the evidence index takes against walking every room's evidence list, with unbounded
+         lists and with evidence fading after 20 and 200 ghost updates, and how often the two disagreed.
+return: none
+*/
+void runEvidenceIndexBenchmark()
+{
+    static const long fadeTimes[3] = { 0, 20, 200 };
+    printf("Evidence index against a walk over %d rooms, %d ghost updates each\n", EVIDENCE_CHECK_ROOMS, EVIDENCE_CHECK_UPDATES);
+    printf("=================================\n");
+    printf("%-10s %10s %12s %12s %10s\n", "Fade", "Checks", "Index ns", "Walk ns", "Mismatches");
+    for (int i = 0; i < 3; i++)
+    {
+        long checks;
+        long mismatches;
+        double indexTime;
+        double walkTime;
+        measureEvidenceIndex(fadeTimes[i], &checks, &mismatches, &indexTime, &walkTime);
+        char fade[MAX_STR];
+        snprintf(fade, MAX_STR, fadeTimes[i] > 0 ? "%ld" : "never", fadeTimes[i]);
+        printf("%-10s %10ld %12.1f %12.1f %10ld\n", fade, checks, indexTime, walkTime, mismatches);
+    }
+}
@@ -0,0 +1,289 @@
+#include "defs.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// how one branch ended, written by the branch's process
+typedef struct BranchOutcome {
+    ResultRecordType record;
+    //turns taken after the branch point
+    long turns;
+    int done;
+} BranchOutcomeType;
+
+// a process slot, at most one branch runs in it at a time and counts its game in the slot's sketch
+typedef struct BranchSlot {
+    GameSketchType sketch;
+    pid_t pid;
+    int branch;
+} BranchSlotType;
+
+/*
+Function: int droppedAllEvidence(BranchPointType *point)
+Purpose: Branch point reached once the ghost has left every one of its three evidence types at least once.
+in: point - Pointer to the BranchPointType structure
+return: Returns C_TRUE once the point is reached
+*/
+static int droppedAllEvidence(BranchPointType *point)
+{
+    return __builtin_popcount(point->game->ghost->dropped) >= MAX_EVIDENCE;
+}
+
+/*
+Function: int collectedEvidence(BranchPointType *point)
+Purpose: Branch point reached once the hunters have collected their first evidence.
+in: point - Pointer to the BranchPointType structure
+return: Returns C_TRUE once the point is reached
+*/
+static int collectedEvidence(BranchPointType *point)
+{
+    return point->game->state.firstEvidence >= 0;
+}
+
+/*
+Function: int hunterLeft(BranchPointType *point)
+Purpose: Branch point reached once the first hunter has been scared or bored out of the house.
+in: point - Pointer to the BranchPointType structure
+return: Returns C_TRUE once the point is reached
+*/
+static int hunterLeft(BranchPointType *point)
+{
+    return point->game->house.hunterCount < NUM_HUNTERS;
+}
+
+/*
+Function: int reachedClock(BranchPointType *point)
+Purpose: Branch point reached once the game's clock gets to the point's.
+in: point - Pointer to the BranchPointType structure
+return: Returns C_TRUE once the point is reached
+*/
+static int reachedClock(BranchPointType *point)
+{
+    return point->game->state.clock >= point->clock;
+}
+
+/*
+Function: int parseBranchPoint(const char *spec, BranchPointType *point)
+Purpose: Reads a branch point: dropped (the ghost has left all three of its evidence types), collected (the first
+         evidence was collected), exit (the first hunter left) or a number, the clock in ghost updates.
+in: spec - The branch point as given on the command line
+out: point - Pointer to the BranchPointType structure filled in
+return: Returns 0 on success, -1 if spec isn't a branch point
+*/
+int parseBranchPoint(const char *spec, BranchPointType *point)
+{
+    char *end;
+    point->game = NULL;
+    point->clock = strtol(spec, &end, 10);
+    if (strcmp(spec, "dropped") == 0)
+    {
+        point->reached = droppedAllEvidence;
+        point->name = "the ghost has dropped all three evidence types";
+    }
+    else if (strcmp(spec, "collected") == 0)
+    {
+        point->reached = collectedEvidence;
+        point->name = "the first evidence was collected";
+    }
+    else if (strcmp(spec, "exit") == 0)
+    {
+        point->reached = hunterLeft;
+        point->name = "the first hunter has left";
+    }
+    else if (*spec != '\0' && *end == '\0' && point->clock > 0)
+    {
+        point->reached = reachedClock;
+        point->name = "the clock has got to the branch point";
+    }
+    else
+    {
+        printf("Error: Unknown branch point %s, use dropped, collected, exit or a clock\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+Function: int pointReached(void *arg)
+Purpose: Tells the scheduler to pause once the branch point is reached.
+in/out: arg - Pointer to the BranchPointType structure
+return: Returns C_TRUE once the point is reached
+*/
+static int pointReached(void *arg)
+{
+    BranchPointType *point = (BranchPointType *)arg;
+    return point->reached(point);
+}
+
+/*
+Function: void runBranch(CoopGameType *coopGame, SchedulerType *scheduler, SimConfigType *config, unsigned int seed, long prefixTurns, BranchOutcomeType *outcome, BranchSlotType *slot)
+Purpose: The body of a branch's process. It has a copy on write copy of the paused game, gives every agent a random
+         stream of the branch's own, plays the game out and writes how it ended to shared memory.
+in/out: coopGame - Pointer to the paused CoopGameType structure
+in/out: scheduler - Pointer to the SchedulerType structure its agents wait on
+in: config - Pointer to the SimConfigType structure the game was set up with
+in: seed - Seed the branch's agents draw their random numbers from
+in: prefixTurns - Turns taken before the branch point
+out: outcome - Pointer to the BranchOutcomeType structure of the branch
+in/out: slot - Pointer to the BranchSlotType structure the branch runs in
+return: none, it doesn't return
+*/
+static void runBranch(CoopGameType *coopGame, SchedulerType *scheduler, SimConfigType *config, unsigned int seed, long prefixTurns, BranchOutcomeType *outcome, BranchSlotType *slot)
+{
+    GameType *game = &coopGame->game;
+    game->state.seed = seed;
+    for (int agent = 0; agent <= NUM_HUNTERS; agent++)
+    {
+        coopGame->agents[agent].seed = agentSeed(seed, agent);
+    }
+
+    SimConfigType branchConfig = *config;
+    branchConfig.results = openMemoryResults(&outcome->record, 1, 0);
+    branchConfig.sketch = config->sketch != NULL ? &slot->sketch : NULL;
+    runTurnsUntil(scheduler, NULL, NULL);
+    outcome->turns = scheduler->turns - prefixTurns;
+    finishGame(game, &branchConfig);
+    closeResults(branchConfig.results);
+    fflush(stdout);
+    __atomic_store_n(&outcome->done, C_TRUE, __ATOMIC_RELEASE);
+    _exit(0);
+}
+
+/*
+Function: int waitBranch(BranchSlotType *slots, int numProcs)
+Purpose: Waits for a branch's process to exit and frees its slot.
+in/out: slots - Array of numProcs BranchSlotType structures
+in: numProcs - Number of slots
+return: Returns the index of the slot freed, -1 if no branch is running
+*/
+static int waitBranch(BranchSlotType *slots, int numProcs)
+{
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, 0)) > 0 || errno == EINTR)
+    {
+        for (int slot = 0; pid > 0 && slot < numProcs; slot++)
+        {
+            if (slots[slot].pid != pid)
+            {
+                continue;
+            }
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                printf("Error: Branch %d died before it finished\n", slots[slot].branch);
+            }
+            slots[slot].pid = 0;
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/*
+Function: int runBranches(SimConfigType *config, char hunterNames[][MAX_STR], BranchPointType *point, int branches, int numProcs, int wins[])
+Purpose: Plays a game on this thread until a branch point, then plays it out many times from there, each branch a
+         forked process with a copy on write copy of the paused game and random streams of its own, at most numProcs
+         at a time. The game up to the point is played only once, so each branch only costs its continuation. Branch b's
+         agents draw the random numbers a game seeded with the config's seed plus 1 + b would.
+in/out: config - Pointer to the SimConfigType structure the game is set up with, its results writer and sketch get
+        every branch's game
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in/out: point - Pointer to the BranchPointType structure to pause at
+in: branches - Number of branches
+in: numProcs - Number of branches played at once
+in/out: wins - Array of RESULT_COUNT counts of branches by how they ended, added to
+return: Returns the number of branches played, 0 if the game ended before the branch point
+*/
+int runBranches(SimConfigType *config, char hunterNames[][MAX_STR], BranchPointType *point, int branches, int numProcs, int wins[])
+{
+    CoopGameType *coopGame = malloc(sizeof(CoopGameType));
+    if (coopGame == NULL)
+    {
+        printf("Error allocating memory for game\n");
+        exit(1);
+    }
+    SchedulerType scheduler;
+    initScheduler(&scheduler);
+    startCoopGame(coopGame, config, hunterNames, &scheduler);
+    point->game = &coopGame->game;
+
+    struct timespec start;
+    struct timespec paused;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!runTurnsUntil(&scheduler, pointReached, point))
+    {
+        printf("\nGame %u ended before %s, there is nothing to branch\n", config->seed, point->name);
+        freeGame(&coopGame->game);
+        free(coopGame);
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &paused);
+    long prefixTurns = scheduler.turns;
+    printf("\nPaused game %u at clock %ld after %ld turns, once %s, playing %d branches on %d processes\n",
+           config->seed, coopGame->game.state.clock, prefixTurns, point->name, branches, numProcs);
+
+    BranchOutcomeType *outcomes = mmap(NULL, branches * sizeof(BranchOutcomeType), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    BranchSlotType *slots = mmap(NULL, numProcs * sizeof(BranchSlotType), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (outcomes == MAP_FAILED || slots == MAP_FAILED)
+    {
+        printf("Error mapping shared memory for the branches\n");
+        exit(1);
+    }
+
+    int running = 0;
+    for (int branch = 0; branch < branches; branch++)
+    {
+        int slot = running < numProcs ? running++ : waitBranch(slots, numProcs);
+        // anything still buffered would be printed again by the branch
+        fflush(stdout);
+        slots[slot].branch = branch;
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            runBranch(coopGame, &scheduler, config, config->seed + 1 + branch, prefixTurns, &outcomes[branch], &slots[slot]);
+        }
+        if (pid < 0)
+        {
+            printf("Error: Failed to fork branch %d\n", branch);
+            exit(1);
+        }
+        slots[slot].pid = pid;
+    }
+    while (waitBranch(slots, numProcs) >= 0)
+    {
+        // every branch is waited for
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int played = 0;
+    long turns = 0;
+    for (int branch = 0; branch < branches; branch++)
+    {
+        if (!outcomes[branch].done)
+        {
+            continue;
+        }
+        wins[outcomes[branch].record.winner]++;
+        turns += outcomes[branch].turns;
+        if (config->results != NULL)
+        {
+            appendResult(config->results, &outcomes[branch].record);
+        }
+        played++;
+    }
+    for (int slot = 0; config->sketch != NULL && slot < numProcs; slot++)
+    {
+        mergeGameSketch(config->sketch, &slots[slot].sketch);
+    }
+
+    double prefixSeconds = (paused.tv_sec - start.tv_sec) + (paused.tv_nsec - start.tv_nsec) / 1e9;
+    double seconds = (end.tv_sec - paused.tv_sec) + (end.tv_nsec - paused.tv_nsec) / 1e9;
+    printf("\n%d branches in %.2f s: %.0f branches/s, %.0f turns each after the branch point against %ld turns (%.4f s) to get there\n",
+           played, seconds, played / seconds, (double)turns / (played > 0 ? played : 1), prefixTurns, prefixSeconds);
+
+    munmap(slots, numProcs * sizeof(BranchSlotType));
+    munmap(outcomes, branches * sizeof(BranchOutcomeType));
+    freeGame(&coopGame->game);
+    free(coopGame);
+    return played;
+}
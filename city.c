@@ -0,0 +1,240 @@
+#include "defs.h"
+
+// one house of the city, it keeps its worker and its layout for every game played in it
+typedef struct CitySite {
+    CoopGameType coopGame;
+    //the layout every game in this house copies
+    HouseTemplateType *house;
+    //the worker the house's games are played on and the node its rooms are placed on
+    SchedulerType *scheduler;
+    int node;
+    //agents of the current game still playing
+    int playing;
+    int played;
+    int wins[RESULT_COUNT];
+    //game clock summed over the games played
+    long length;
+    //seed of the house's first game
+    unsigned int seed;
+    //options of the whole city, with the sketch of the house's worker
+    SimConfigType config;
+    char (*hunterNames)[MAX_STR];
+    int games;
+} CitySiteType;
+
+static void siteAgentFinished(AgentType *agent, SchedulerType *scheduler);
+
+/*
+Function: void startSiteGame(CitySiteType *site)
+Purpose: Sets up the next game of a house from its own layout and gives its agents to the house's worker. The first
+         game allocates the house's rooms and the rest are copied into them again, so games started while the city
+         is running allocate nothing.
+in/out: site - Pointer to the CitySiteType structure of the house
+return: none
+*/
+static void startSiteGame(CitySiteType *site)
+{
+    SimConfigType config = site->config;
+    config.seed = site->seed + site->played;
+    config.numRooms = 0;
+    config.house = site->house;
+    if (site->played == 0)
+    {
+        startCoopGame(&site->coopGame, &config, site->hunterNames, site->scheduler);
+    }
+    else
+    {
+        restartCoopGame(&site->coopGame, &config, site->hunterNames, site->scheduler);
+    }
+
+    for (int agent = 0; agent <= NUM_HUNTERS; agent++)
+    {
+        site->coopGame.agents[agent].finished = siteAgentFinished;
+        site->coopGame.agents[agent].owner = site;
+    }
+    site->playing = NUM_HUNTERS + 1;
+}
+
+/*
+Function: void siteAgentFinished(AgentType *agent, SchedulerType *scheduler)
+Purpose: Counts an agent of a house that is done. Once the last one is, the game is scored and, if the house has
+         games left, the next one is started right away on the same worker in the same rooms.
+in/out: agent - Pointer to the AgentType structure that is done, its owner is its CitySiteType
+in/out: scheduler - Pointer to the SchedulerType structure of the worker running the house
+return: none
+*/
+static void siteAgentFinished(AgentType *agent, SchedulerType *scheduler)
+{
+    (void)scheduler;
+    CitySiteType *site = (CitySiteType *)agent->owner;
+    if (--site->playing > 0)
+    {
+        return;
+    }
+
+    GameType *game = &site->coopGame.game;
+    site->length += game->state.clock;
+    site->wins[scoreGame(game, &site->config)]++;
+    site->played++;
+    if (site->played < site->games)
+    {
+        startSiteGame(site);
+    }
+}
+
+/*
+Function: int compareRates(const void *a, const void *b)
+Purpose: Orders win rates from lowest to highest, for qsort.
+in: a - Pointer to the first double
+in: b - Pointer to the second double
+return: Returns a negative number, zero or a positive number as a is lower than, equal to or higher than b
+*/
+static int compareRates(const void *a, const void *b)
+{
+    double rateA = *(const double *)a;
+    double rateB = *(const double *)b;
+    return (rateA > rateB) - (rateA < rateB);
+}
+
+/*
+Function: void printCityReport(CitySiteType *sites, int numHouses, int gamesPerHouse, WorkerPoolType *pool, double seconds)
+Purpose: Prints how the games went across the houses of the city and how fast the workers got through them.
+in: sites - Array of numHouses CitySiteType structures, all played out
+in: numHouses - Number of houses
+in: gamesPerHouse - Number of games played in each house
+in: pool - Pointer to the WorkerPoolType structure the city was played on
+in: seconds - Wall clock time the city took
+return: none
+*/
+static void printCityReport(CitySiteType *sites, int numHouses, int gamesPerHouse, WorkerPoolType *pool, double seconds)
+{
+    double *rates = malloc(numHouses * sizeof(double));
+    if (rates == NULL)
+    {
+        printf("Error allocating memory for city report\n");
+        exit(1);
+    }
+    long length = 0;
+    for (int i = 0; i < numHouses; i++)
+    {
+        rates[i] = (double)sites[i].wins[RESULT_HUNTERS_WIN] / gamesPerHouse;
+        length += sites[i].length;
+    }
+    qsort(rates, numHouses, sizeof(double), compareRates);
+
+    long turns = 0;
+    long minTurns = pool->schedulers[0].turns;
+    long maxTurns = pool->schedulers[0].turns;
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        long workerTurns = pool->schedulers[i].turns;
+        turns += workerTurns;
+        minTurns = workerTurns < minTurns ? workerTurns : minTurns;
+        maxTurns = workerTurns > maxTurns ? workerTurns : maxTurns;
+    }
+    long games = (long)numHouses * gamesPerHouse;
+
+    printf("\nCity of %d houses, %d games each, on %d threads\n", numHouses, gamesPerHouse, pool->numThreads);
+    printf("=================================\n");
+    printf("Hunter win rate per house: min %.2f, p10 %.2f, median %.2f, p90 %.2f, max %.2f\n", rates[0],
+           rates[numHouses / 10], rates[numHouses / 2], rates[numHouses * 9 / 10], rates[numHouses - 1]);
+    printf("Mean game length: %.1f ghost updates\n", (double)length / games);
+    printf("%ld games in %.2f s: %.0f games/s, %.0f turns/s (%.0f ns a turn)\n", games, seconds, games / seconds,
+           turns / seconds, seconds * 1e9 / (turns > 0 ? turns : 1));
+    printf("Turns per worker: min %ld, max %ld\n", minTurns, maxTurns);
+    free(rates);
+}
+
+/*
+Function: void runCity(SimConfigType *config, char hunterNames[][MAX_STR], int numHouses, int gamesPerHouse, WorkerPoolType *pool, int wins[])
+Purpose: Plays a city of houses all at once on the threads of a worker pool. House i has a worker of its own for its
+         whole run, i modulo the number of threads, and its rooms are placed on that worker's node. With --rooms each
+         house is generated once from the seed of its first game, otherwise every house is the default one. As soon as
+         a game ends its house starts the next, so a house with short games doesn't wait for the others. Each worker
+         counts its houses' games in a sketch of its own, merged into the config's once the city is played out.
+in/out: config - Pointer to the SimConfigType structure, game g of house i is seeded with its seed plus i * gamesPerHouse + g
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: numHouses - Number of houses
+in: gamesPerHouse - Number of games played in each house
+in/out: pool - Pointer to the started WorkerPoolType structure the houses are played on
+in/out: wins - Array of RESULT_COUNT counts of games by how they ended, added to
+return: none
+*/
+void runCity(SimConfigType *config, char hunterNames[][MAX_STR], int numHouses, int gamesPerHouse, WorkerPoolType *pool, int wins[])
+{
+    CitySiteType *sites = malloc(numHouses * sizeof(CitySiteType));
+    if (sites == NULL)
+    {
+        printf("Error allocating memory for city\n");
+        exit(1);
+    }
+
+    GameSketchType *sketches = malloc(pool->numThreads * sizeof(GameSketchType));
+    if (sketches == NULL)
+    {
+        printf("Error allocating memory for city\n");
+        exit(1);
+    }
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        initScheduler(&pool->schedulers[i]);
+        initGameSketch(&sketches[i]);
+    }
+    for (int i = 0; i < numHouses; i++)
+    {
+        CitySiteType *site = &sites[i];
+        int worker = i % pool->numThreads;
+        memset(site->wins, 0, sizeof(site->wins));
+        site->scheduler = &pool->schedulers[worker];
+        site->node = getCoreNode(&config->placement, getWorkerCore(&config->placement, worker));
+        site->played = 0;
+        site->length = 0;
+        site->seed = config->seed + (unsigned int)i * gamesPerHouse;
+        site->config = *config;
+        site->config.node = site->node;
+        site->config.sketch = config->sketch != NULL ? &sketches[worker] : NULL;
+        site->hunterNames = hunterNames;
+        site->games = gamesPerHouse;
+
+        setAllocPhase(PHASE_SETUP);
+        site->house = config->house;
+        if (config->numRooms > 0)
+        {
+            seedRandom(site->seed);
+            site->house = createHouseTemplate(config->numRooms);
+        }
+        startSiteGame(site);
+    }
+    if (config->stats != NULL)
+    {
+        setStatsRooms(config->stats, &sites[0].coopGame.game.house);
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    runWorkerPool(pool);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    setAllocPhase(PHASE_TEARDOWN);
+
+    for (int i = 0; i < numHouses; i++)
+    {
+        // the last game of each house was only scored, its rooms are freed here
+        freeGame(&sites[i].coopGame.game);
+        for (int result = 0; result < RESULT_COUNT; result++)
+        {
+            wins[result] += sites[i].wins[result];
+        }
+        if (sites[i].house != config->house)
+        {
+            freeHouseTemplate(sites[i].house);
+        }
+    }
+    for (int i = 0; config->sketch != NULL && i < pool->numThreads; i++)
+    {
+        mergeGameSketch(config->sketch, &sketches[i]);
+    }
+    free(sketches);
+    printCityReport(sites, numHouses, gamesPerHouse, pool, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    free(sites);
+}
@@ -0,0 +1,377 @@
+#include "defs.h"
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// a batch of games, the worker that plays it fills in how they ended and then marks it done
+typedef struct ProcBatch {
+    int wins[RESULT_COUNT];
+    int done;
+    //times the batch was handed out again after a worker died with it
+    int retries;
+} ProcBatchType;
+
+// what a worker has finished so far, the sketch of its games up to and including lastBatch
+typedef struct ProcTally {
+    GameSketchType sketch;
+    int lastBatch;
+} ProcTallyType;
+
+// a worker process's own slab, only it writes the batch it is playing
+typedef struct ProcWorker {
+    pid_t pid;
+    int current;
+    //batches the worker finished
+    int played;
+    //two tallies, the worker builds the next one in the other and switching active commits it
+    ProcTallyType tallies[2];
+    int active;
+} __attribute__((aligned(CACHE_LINE))) ProcWorkerType;
+
+// the memory shared by the coordinator and its workers, mapped before they are forked
+typedef struct ProcShared {
+    //batch ids to play, the coordinator is the only one adding at tail, workers claim from head
+    long head __attribute__((aligned(CACHE_LINE)));
+    long tail __attribute__((aligned(CACHE_LINE)));
+    int *queue;
+    long capacity;
+    ProcBatchType *batches;
+    int numBatches;
+    //games in a batch, the last one may have fewer
+    int batchGames;
+    ProcWorkerType *workers;
+    //one record per game of the run, batch b writes its games from b * batchGames on, NULL without --results
+    ResultRecordType *records;
+} ProcSharedType;
+
+/*
+Function: void *mapShared(size_t size)
+Purpose: Maps zeroed memory that forked processes share with the one mapping it.
+in: size - Number of bytes
+return: Returns a pointer to the memory, exits if it can't be mapped
+*/
+static void *mapShared(size_t size)
+{
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        printf("Error mapping shared memory for the workers\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/*
+Function: void pushBatch(ProcSharedType *shared, int batch)
+Purpose: Adds a batch to the end of the queue. Only the coordinator calls it, the slot is written before the tail
+         that hands it to the workers.
+in/out: shared - Pointer to the ProcSharedType structure
+in: batch - Index of the batch
+return: none
+*/
+static void pushBatch(ProcSharedType *shared, int batch)
+{
+    long tail = __atomic_load_n(&shared->tail, __ATOMIC_RELAXED);
+    shared->queue[tail] = batch;
+    __atomic_store_n(&shared->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/*
+Function: int claimBatch(ProcSharedType *shared)
+Purpose: Takes the batch at the head of the queue. Workers race for it with a compare and swap of the head, one that
+         loses just tries the next one, so no worker ever waits on another.
+in/out: shared - Pointer to the ProcSharedType structure
+return: Returns the index of the batch, -1 if the queue is empty
+*/
+static int claimBatch(ProcSharedType *shared)
+{
+    long head = __atomic_load_n(&shared->head, __ATOMIC_ACQUIRE);
+    while (head < __atomic_load_n(&shared->tail, __ATOMIC_ACQUIRE))
+    {
+        int batch = shared->queue[head];
+        if (__atomic_compare_exchange_n(&shared->head, &head, head + 1, C_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return batch;
+        }
+    }
+    return -1;
+}
+
+/*
+Function: void runProcWorker(ProcSharedType *shared, int worker, SimConfigType *config, char hunterNames[][MAX_STR], int games)
+Purpose: The body of a worker process. It plays the batches it claims on a worker pool of one thread, pinned to its own
+         core, until the queue is empty, then exits without running the coordinator's exit handlers.
+in/out: shared - Pointer to the ProcSharedType structure
+in: worker - Index of the worker's slab
+in: config - Pointer to the SimConfigType structure of the run, batch b's games are seeded from its seed plus b times the batch size
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: games - Number of games in the whole run
+return: none, it doesn't return
+*/
+static void runProcWorker(ProcSharedType *shared, int worker, SimConfigType *config, char hunterNames[][MAX_STR], int games)
+{
+    ProcWorkerType *slab = &shared->workers[worker];
+    // the pool's one thread gets the worker's own core, and the houses of its games that core's node
+    SimConfigType workerConfig = *config;
+    workerConfig.placement.cores[0] = getWorkerCore(&config->placement, worker);
+    workerConfig.placement.numCores = 1;
+    workerConfig.node = getCoreNode(&config->placement, workerConfig.placement.cores[0]);
+    config = &workerConfig;
+    WorkerPoolType pool;
+    startWorkerPool(&pool, 1, &config->placement);
+
+    for (int batch = claimBatch(shared); batch >= 0; batch = claimBatch(shared))
+    {
+        __atomic_store_n(&slab->current, batch, __ATOMIC_RELEASE);
+        int first = batch * shared->batchGames;
+        int count = games - first < shared->batchGames ? games - first : shared->batchGames;
+        SimConfigType batchConfig = *config;
+        batchConfig.seed = config->seed + first;
+        batchConfig.results = shared->records != NULL ? openMemoryResults(shared->records + first, count, 0) : NULL;
+
+        ProcTallyType *next = &slab->tallies[!slab->active];
+        *next = slab->tallies[slab->active];
+        batchConfig.sketch = config->sketch != NULL ? &next->sketch : NULL;
+
+        int wins[RESULT_COUNT] = {0};
+        runCoopGames(&batchConfig, hunterNames, count, &pool, wins, NULL, NULL);
+        closeResults(batchConfig.results);
+        fflush(stdout);
+
+        // the batch counts once the worker's active tally includes it, the coordinator marks it done if the
+        // worker dies between the two
+        memcpy(shared->batches[batch].wins, wins, sizeof(wins));
+        next->lastBatch = batch;
+        __atomic_store_n(&slab->active, !slab->active, __ATOMIC_RELEASE);
+        __atomic_store_n(&shared->batches[batch].done, C_TRUE, __ATOMIC_RELEASE);
+        __atomic_store_n(&slab->current, -1, __ATOMIC_RELEASE);
+        slab->played++;
+    }
+    stopWorkerPool(&pool);
+    _exit(0);
+}
+
+/*
+Function: void forkProcWorker(ProcSharedType *shared, int worker, SimConfigType *config, char hunterNames[][MAX_STR], int games)
+Purpose: Starts a worker process on a slab, the first time or in place of one that died.
+in/out: shared - Pointer to the ProcSharedType structure
+in: worker - Index of the slab
+in: config - Pointer to the SimConfigType structure of the run
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: games - Number of games in the whole run
+return: none
+*/
+static void forkProcWorker(ProcSharedType *shared, int worker, SimConfigType *config, char hunterNames[][MAX_STR], int games)
+{
+    // anything still buffered would be printed again by the child
+    fflush(stdout);
+    shared->workers[worker].current = -1;
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        printf("Error: Failed to fork worker %d\n", worker);
+        shared->workers[worker].pid = 0;
+        return;
+    }
+    if (pid == 0)
+    {
+        runProcWorker(shared, worker, config, hunterNames, games);
+    }
+    shared->workers[worker].pid = pid;
+}
+
+/*
+Function: int reissueBatch(ProcSharedType *shared, int batch)
+Purpose: Puts a batch that no worker will finish back on the queue, unless it has been handed out PROC_MAX_RETRIES times already.
+in/out: shared - Pointer to the ProcSharedType structure
+in: batch - Index of the batch
+return: Returns C_TRUE if the batch was put back
+*/
+static int reissueBatch(ProcSharedType *shared, int batch)
+{
+    ProcBatchType *entry = &shared->batches[batch];
+    if (entry->retries >= PROC_MAX_RETRIES)
+    {
+        printf("Error: Giving up on batch %d after %d workers died playing it\n", batch, PROC_MAX_RETRIES + 1);
+        // it isn't looked at again
+        entry->retries++;
+        return C_FALSE;
+    }
+    entry->retries++;
+    pushBatch(shared, batch);
+    return C_TRUE;
+}
+
+/*
+Function: int recoverWorker(ProcSharedType *shared, int worker)
+Purpose: Looks at the slab of a worker that died. If it had already committed the batch it was on, the batch is marked
+         done, otherwise it is handed out again.
+in/out: shared - Pointer to the ProcSharedType structure
+in: worker - Index of the slab
+return: Returns C_TRUE if a batch was put back on the queue
+*/
+static int recoverWorker(ProcSharedType *shared, int worker)
+{
+    ProcWorkerType *slab = &shared->workers[worker];
+    int batch = slab->current;
+    if (batch < 0 || shared->batches[batch].done)
+    {
+        return C_FALSE;
+    }
+    if (slab->tallies[slab->active].lastBatch == batch)
+    {
+        shared->batches[batch].done = C_TRUE;
+        return C_FALSE;
+    }
+    return reissueBatch(shared, batch);
+}
+
+/*
+Function: int sweepBatches(ProcSharedType *shared)
+Purpose: Once every worker has exited, puts back any batch that still isn't done, e.g. one a worker died with before
+         it could note it in its slab.
+in/out: shared - Pointer to the ProcSharedType structure
+return: Returns the number of batches put back
+*/
+static int sweepBatches(ProcSharedType *shared)
+{
+    int reissued = 0;
+    for (int batch = 0; batch < shared->numBatches; batch++)
+    {
+        if (!shared->batches[batch].done && shared->batches[batch].retries <= PROC_MAX_RETRIES && reissueBatch(shared, batch))
+        {
+            reissued++;
+        }
+    }
+    return reissued;
+}
+
+/*
+Function: int runCoordinator(SimConfigType *config, char hunterNames[][MAX_STR], int games, int numWorkers, int wins[])
+Purpose: Plays a run of games on worker processes instead of threads. The games are cut into batches, each worker's
+         even share of them but at most PROC_BATCH_GAMES, that the workers pull from a queue in shared memory, each
+         one playing its batches on a one thread worker pool. A worker that dies is replaced and the batches it left unfinished are handed out
+         again, so a crash costs at most one batch of work. The games are seeded as a threaded run's would be. Each
+         worker keeps the sketch of the batches it committed in its slab, they are merged into the config's at the end.
+in/out: config - Pointer to the SimConfigType structure, game i is seeded with its seed plus i, its results writer
+        gets every game's record once the workers are done
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: games - Number of games
+in: numWorkers - Number of worker processes
+in/out: wins - Array of RESULT_COUNT counts of games by how they ended, added to
+return: Returns the number of games played, fewer than asked only if batches were given up on
+*/
+int runCoordinator(SimConfigType *config, char hunterNames[][MAX_STR], int games, int numWorkers, int wins[])
+{
+    ProcSharedType *shared = mapShared(sizeof(ProcSharedType));
+    // small runs are still spread over every worker, big ones capped so a crash loses at most PROC_BATCH_GAMES games
+    shared->batchGames = (games + numWorkers - 1) / numWorkers;
+    shared->batchGames = shared->batchGames > PROC_BATCH_GAMES ? PROC_BATCH_GAMES : shared->batchGames;
+    shared->batchGames = shared->batchGames < 1 ? 1 : shared->batchGames;
+    shared->numBatches = (games + shared->batchGames - 1) / shared->batchGames;
+    shared->capacity = (long)shared->numBatches * (PROC_MAX_RETRIES + 1);
+    shared->queue = mapShared(shared->capacity * sizeof(int));
+    shared->batches = mapShared(shared->numBatches * sizeof(ProcBatchType));
+    shared->workers = mapShared(numWorkers * sizeof(ProcWorkerType));
+    shared->records = config->results != NULL ? mapShared((size_t)games * sizeof(ResultRecordType)) : NULL;
+    for (int batch = 0; batch < shared->numBatches; batch++)
+    {
+        pushBatch(shared, batch);
+    }
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+        shared->workers[worker].tallies[0].lastBatch = -1;
+        shared->workers[worker].tallies[1].lastBatch = -1;
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+        forkProcWorker(shared, worker, config, hunterNames, games);
+    }
+
+    // every worker exits once the queue is empty, so the run is over when none are left and nothing was left undone
+    int restarts = 0;
+    int reissued;
+    do
+    {
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, 0)) > 0 || errno == EINTR)
+        {
+            int worker = 0;
+            while (worker < numWorkers && shared->workers[worker].pid != pid)
+            {
+                worker++;
+            }
+            if (pid <= 0 || worker == numWorkers)
+            {
+                continue;
+            }
+            shared->workers[worker].pid = 0;
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            {
+                continue;
+            }
+            printf("Worker %d (pid %d) died, handing its batch out again\n", worker, (int)pid);
+            if (recoverWorker(shared, worker))
+            {
+                forkProcWorker(shared, worker, config, hunterNames, games);
+                restarts++;
+            }
+        }
+
+        reissued = sweepBatches(shared);
+        for (int worker = 0; worker < numWorkers && worker < reissued; worker++)
+        {
+            forkProcWorker(shared, worker, config, hunterNames, games);
+            restarts++;
+        }
+    } while (reissued > 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for (int worker = 0; config->sketch != NULL && worker < numWorkers; worker++)
+    {
+        ProcWorkerType *slab = &shared->workers[worker];
+        mergeGameSketch(config->sketch, &slab->tallies[slab->active].sketch);
+    }
+    int played = 0;
+    for (int batch = 0; batch < shared->numBatches; batch++)
+    {
+        if (!shared->batches[batch].done)
+        {
+            continue;
+        }
+        int first = batch * shared->batchGames;
+        int count = games - first < shared->batchGames ? games - first : shared->batchGames;
+        for (int result = 0; result < RESULT_COUNT; result++)
+        {
+            wins[result] += shared->batches[batch].wins[result];
+        }
+        for (int i = 0; shared->records != NULL && i < count; i++)
+        {
+            appendResult(config->results, &shared->records[first + i]);
+        }
+        played += count;
+    }
+
+    printf("\n%d games in %.2f s on %d processes: %.0f games/s, %d workers restarted\n", played, seconds, numWorkers,
+           played / seconds, restarts);
+    for (int worker = 0; worker < numWorkers; worker++)
+    {
+        printf("Worker %d played %d batches\n", worker, shared->workers[worker].played);
+    }
+
+    if (shared->records != NULL)
+    {
+        munmap(shared->records, (size_t)games * sizeof(ResultRecordType));
+    }
+    munmap(shared->workers, numWorkers * sizeof(ProcWorkerType));
+    munmap(shared->batches, shared->numBatches * sizeof(ProcBatchType));
+    munmap(shared->queue, shared->capacity * sizeof(int));
+    munmap(shared, sizeof(ProcSharedType));
+    return played;
+}
@@ -0,0 +1,216 @@
+#include "defs.h"
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+Function: int parseJob(char *line, SimConfigType *job, int *games, FILE *stream)
+Purpose: Reads the options of a job from a line of key=value pairs: games, seed, rooms, policy (random, frontier, tracker or party) and fade.
+         Options that aren't given keep the daemon's own.
+in/out: line - The request line, split up while it is read
+in/out: job - Pointer to the SimConfigType structure of the job, its options are overwritten
+out: games - Number of games the job asks for
+in/out: stream - Stream the client reads replies from, an error line is written to it if the job is bad
+return: Returns 0 on success, -1 if the line isn't a valid job
+*/
+static int parseJob(char *line, SimConfigType *job, int *games, FILE *stream)
+{
+    *games = 1;
+    for (char *option = strtok(line, " \t\r\n"); option != NULL; option = strtok(NULL, " \t\r\n"))
+    {
+        char *value = strchr(option, '=');
+        if (value == NULL)
+        {
+            fprintf(stream, "error option %s should be key=value\n", option);
+            return -1;
+        }
+        *value++ = '\0';
+        if (strcmp(option, "games") == 0)
+        {
+            *games = atoi(value);
+        }
+        else if (strcmp(option, "seed") == 0)
+        {
+            job->seed = (unsigned int)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(option, "rooms") == 0)
+        {
+            job->numRooms = atoi(value);
+        }
+        else if (strcmp(option, "policy") == 0 && strcmp(value, "random") == 0)
+        {
+            job->hunterPolicy = POLICY_RANDOM;
+        }
+        else if (strcmp(option, "policy") == 0 && strcmp(value, "frontier") == 0)
+        {
+            job->hunterPolicy = POLICY_FRONTIER;
+        }
+        else if (strcmp(option, "policy") == 0 && strcmp(value, "tracker") == 0)
+        {
+            job->hunterPolicy = POLICY_TRACKER;
+        }
+        else if (strcmp(option, "policy") == 0 && strcmp(value, "party") == 0)
+        {
+            job->hunterPolicy = POLICY_PARTY;
+        }
+        else if (strcmp(option, "fade") == 0)
+        {
+            job->fadeTime = atol(value);
+        }
+        else
+        {
+            fprintf(stream, "error unknown option %s=%s\n", option, value);
+            return -1;
+        }
+    }
+
+    // a bad job must not take the daemon down with it
+    if (*games <= 0 || (job->numRooms != 0 && job->numRooms < 3) || job->fadeTime < 0)
+    {
+        fprintf(stream, "error games must be positive, rooms 0 or at least 3 and fade not negative\n");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+Function: void runJob(SimConfigType *job, WorkerPoolType *pool, char hunterNames[][MAX_STR], int games, FILE *stream)
+Purpose: Plays the games of a job on the warm worker pool, DAEMON_BATCH_GAMES at a time, streaming a line per game
+         and a last line with the totals.
+in/out: job - Pointer to the SimConfigType structure of the job
+in/out: pool - Pointer to the daemon's started WorkerPoolType structure
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: games - Number of games to play
+in/out: stream - Stream the client reads replies from
+return: none
+*/
+static void runJob(SimConfigType *job, WorkerPoolType *pool, char hunterNames[][MAX_STR], int games, FILE *stream)
+{
+    int wins[RESULT_COUNT] = {0};
+    unsigned int seed = job->seed;
+    for (int played = 0; played < games; played += DAEMON_BATCH_GAMES)
+    {
+        int batch = games - played < DAEMON_BATCH_GAMES ? games - played : DAEMON_BATCH_GAMES;
+        job->seed = seed + played;
+        runCoopGames(job, hunterNames, batch, pool, wins, stream, stdout);
+        fflush(stream);
+    }
+    fprintf(stream, "done %d %d %d %d\n", games, wins[RESULT_HUNTERS_WIN], wins[RESULT_GHOST_WINS], wins[RESULT_GHOST_BORED]);
+    fflush(stream);
+}
+
+/*
+Function: int serveClient(int client, SimConfigType *config, WorkerPoolType *pool, char hunterNames[][MAX_STR])
+Purpose: Runs the jobs a client sends, one per line, until it hangs up or asks the daemon to shut down.
+in: client - The connected socket
+in: config - Pointer to the daemon's SimConfigType structure, each job starts from a copy of it
+in/out: pool - Pointer to the daemon's started WorkerPoolType structure
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: Returns C_TRUE if the client asked for a shutdown
+*/
+static int serveClient(int client, SimConfigType *config, WorkerPoolType *pool, char hunterNames[][MAX_STR])
+{
+    // reading and writing a socket through one FILE needs a seek in between, so each direction gets its own
+    FILE *requests = fdopen(client, "r");
+    FILE *replies = fdopen(dup(client), "w");
+    if (requests == NULL || replies == NULL)
+    {
+        printf("Error: Failed to open the client's streams\n");
+        if (requests != NULL)
+        {
+            fclose(requests);
+        }
+        else
+        {
+            close(client);
+        }
+        return C_FALSE;
+    }
+
+    int stopping = C_FALSE;
+    char line[MAX_STR * 4];
+    while (!stopping && fgets(line, sizeof(line), requests) != NULL)
+    {
+        if (strcmp(line, "shutdown\n") == 0)
+        {
+            fprintf(replies, "bye\n");
+            stopping = C_TRUE;
+            continue;
+        }
+
+        SimConfigType job = *config;
+        job.seed = (unsigned int)time(NULL);
+        int games;
+        if (parseJob(line, &job, &games, replies) == 0)
+        {
+            runJob(&job, pool, hunterNames, games, replies);
+        }
+        fflush(replies);
+    }
+
+    fclose(replies);
+    fclose(requests);
+    return stopping;
+}
+
+/*
+Function: int runDaemon(SimConfigType *config, const char *path, int numThreads)
+Purpose: Serves simulation jobs on a Unix domain socket, keeping the worker threads warm between jobs.
+         Clients are served one at a time, each one can send any number of jobs.
+in/out: config - Pointer to the SimConfigType structure the jobs start from
+in: path - Path of the socket
+in: numThreads - Number of worker threads
+return: Returns 0 once a client asks for a shutdown, -1 if the socket can't be set up
+*/
+int runDaemon(SimConfigType *config, const char *path, int numThreads)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        printf("Error: Socket path %s is too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, DAEMON_BACKLOG) != 0)
+    {
+        printf("Error: Failed to listen on %s\n", path);
+        if (listener >= 0)
+        {
+            close(listener);
+        }
+        return -1;
+    }
+    // a client that hangs up mid job is noticed on the next write instead of killing the daemon
+    signal(SIGPIPE, SIG_IGN);
+
+    char hunterNames[NUM_HUNTERS][MAX_STR];
+    for (int i = 0; i < NUM_HUNTERS; i++)
+    {
+        snprintf(hunterNames[i], MAX_STR, "Hunter %d", i + 1);
+    }
+    WorkerPoolType pool;
+    startWorkerPool(&pool, numThreads, &config->placement);
+    printf("Serving jobs on %s with %d workers\n", path, numThreads);
+    fflush(stdout);
+
+    int stopping = C_FALSE;
+    while (!stopping)
+    {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0)
+        {
+            continue;
+        }
+        stopping = serveClient(client, config, &pool, hunterNames);
+    }
+
+    stopWorkerPool(&pool);
+    close(listener);
+    unlink(path);
+    return 0;
+}
@@ -5,6 +5,9 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <time.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
 
 #define MAX_STR         64
 #define MAX_RUNS        50
@@ -16,39 +19,140 @@
 #define NUM_HUNTERS     4
 #define FEAR_MAX        10
 #define LOGGING         C_TRUE
+//categories compiled in, one bit per enum LogCategory, build with -DLOG_COMPILED=0 to drop every log call
+#ifndef LOG_COMPILED
+#define LOG_COMPILED    0xFF
+#endif
+#define MAX_ROOMS       64
+#define STATS_SHM_NAME  "/fp_stats"
+#define STATS_INTERVAL  100000
+#define STATS_TOP_ROOMS 20
+#define EVIDENCE_RING_SIZE      8
+#define DISTANCE_MATRIX_MAX     1024
+#define NUM_LANDMARKS   8
+#define TRACKER_TARGETS 64
+#define MARKOV_PHASES   (1 + GHOST_WAIT / COOP_TICK)
+#define MARKOV_MAX_GAP  ((HUNTER_WAIT + GHOST_WAIT - 1) / GHOST_WAIT)
+#define MARKOV_MAX_FADE (HUNTER_WAIT / GHOST_WAIT + 1)
+#define MARKOV_CHECK_GAMES      20000
+#define MARKOV_CHECK_SIGMAS     4
+#define GHOST_AGENT     0
+#define CACHE_LINE      64
+#define MAX_CORES       256
+#define MAX_NODES       64
+#define SCALING_MAX_THREADS     64
+#define SCALING_DURATION        200000
+#define GHOST_READERS_MAX       1000
+#define DOORWAY_MAX_HUNTERS     64
+#define EVIDENCE_CHECK_ROOMS    256
+#define EVIDENCE_CHECK_UPDATES  100000
+#define OCCUPANCY_BITS          8
+#define OCCUPANCY_ROOMS         (64 / OCCUPANCY_BITS)
+#define OCCUPANCY_READ_TRIES    16
+#define RESULTS_MAGIC   0x53455246
+#define RESULTS_BLOCK_GAMES     4096
+#define COOP_TICK       200
+#define LOCKSTEP_GAME_OUTPUT    8192
+#define PACER_BUCKETS   4096
+#define DAEMON_BATCH_GAMES      1024
+#define DAEMON_BACKLOG  8
+#define PROC_BATCH_GAMES        256
+#define PROC_MAX_RETRIES        3
+#define SKETCH_SUB_BITS 5
+#define SKETCH_BUCKETS  ((64 - SKETCH_SUB_BITS) << SKETCH_SUB_BITS)
+#define WHEEL_BITS      6
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_LEVELS    4
 
 //made constant
 #define MAX_EVIDENCE    3
 
 typedef enum EvidenceType EvidenceType;
 typedef enum GhostClass GhostClass;
+typedef enum GameResult GameResult;
+typedef enum HunterPolicy HunterPolicy;
+typedef enum AllocPhase AllocPhase;
+typedef enum GameMeasure GameMeasure;
 
 typedef     struct  Ghost   GhostType;
+typedef     struct  GhostView   GhostViewType;
 typedef     struct  Room    RoomType;
 typedef     struct  House   HouseType;
 typedef     struct  RoomList    RoomListType;
 typedef     struct  RoomNode    RoomNodeType;
 typedef     struct  EvidenceList    EvidenceListType;
 typedef     struct  EvidenceNode    EvidenceNodeType;
+typedef     struct  OccupancyShard  OccupancyShardType;
+typedef     struct  EvidenceEntry   EvidenceEntryType;
+typedef     struct  EvidenceIndex   EvidenceIndexType;
 typedef     struct  Hunter   HunterType;
 typedef    struct  EvidenceArray EvidenceArrayType;
 typedef    struct  HunterArray HunterArrayType;
 typedef    struct  sharedState SharedGameState;
+typedef    struct  Placement PlacementType;
+typedef    struct  LiveStats LiveStatsType;
+typedef    struct  Stats StatsType;
+typedef    struct  SimConfig SimConfigType;
+typedef    struct  RoomIndex RoomIndexType;
+typedef    struct  SparseMatrix SparseMatrixType;
+typedef    struct  MarkovModel MarkovModelType;
+typedef    struct  ResultRecord ResultRecordType;
+typedef    struct  ResultsBlock ResultsBlockType;
+typedef    struct  ResultsTrailer ResultsTrailerType;
+typedef    struct  ResultsWriter ResultsWriterType;
+typedef    struct  Game GameType;
+typedef    struct  HouseTemplate HouseTemplateType;
+typedef    struct  Agent AgentType;
+typedef    struct  TimerWheel TimerWheelType;
+typedef    struct  Pacer PacerType;
+typedef    struct  Scheduler SchedulerType;
+typedef    struct  WorkerPool WorkerPoolType;
+typedef    struct  CoopGame CoopGameType;
+typedef    struct  Sketch SketchType;
+typedef    struct  GameSketch GameSketchType;
+typedef    struct  BranchPoint BranchPointType;
+typedef    struct  TurnOutput TurnOutputType;
 
 
 
 enum EvidenceType { EMF, TEMPERATURE, FINGERPRINTS, SOUND, EV_COUNT, EV_UNKNOWN };
 enum GhostClass { POLTERGEIST, BANSHEE, BULLIES, PHANTOM, GHOST_COUNT, GH_UNKNOWN };
+enum HunterPolicy { POLICY_RANDOM, POLICY_FRONTIER, POLICY_TRACKER, POLICY_PARTY };
+enum GameResult { RESULT_HUNTERS_WIN, RESULT_GHOST_WINS, RESULT_GHOST_BORED, RESULT_COUNT };
+enum AllocPhase { PHASE_SETUP, PHASE_RUN, PHASE_TEARDOWN, PHASE_COUNT };
+enum GameMeasure { MEASURE_LENGTH, MEASURE_FIRST_EVIDENCE, MEASURE_FEAR_EXIT, MEASURE_BOREDOM_EXIT, MEASURE_COUNT };
+enum ResultColumn { COL_NUM_ROOMS, COL_POLICY, COL_FADE_TIME, COL_SEED, COL_WINNER, COL_GHOST, COL_IDENTIFIED, COL_LENGTH, COL_EXIT_REASON, COL_EXIT_TIME, COL_EVIDENCE, RESULT_COLUMNS };
 enum LoggerDetails { LOG_FEAR, LOG_BORED, LOG_EVIDENCE, LOG_SUFFICIENT, LOG_INSUFFICIENT, LOG_UNKNOWN };
+enum LogCategory { LOG_CAT_INIT, LOG_CAT_HUNTER_MOVE, LOG_CAT_GHOST_MOVE, LOG_CAT_EVIDENCE, LOG_CAT_REVIEW, LOG_CAT_EXIT, LOG_CATEGORIES };
+
+//logs a record of a category only when it is compiled in and passes the runtime filter, the arguments
+//aren't even evaluated otherwise
+#define LOG_IF(category, call) \
+    do { if (LOGGING && (LOG_COMPILED & (1 << (category))) && logSampled(category)) { call; } } while (0)
 
 // room structs
+//hunter counts of OCCUPANCY_ROOMS rooms packed in one word, so a move between two of them is one atomic add
+struct OccupancyShard {
+    uint64_t counts;
+    //odd while a move to or from a room of another shard is half done
+    unsigned int version;
+    //held by moves between shards, the shard at the lower address is taken first
+    sem_t sem;
+} __attribute__((aligned(CACHE_LINE)));
+
 struct Room {
     char name[MAX_STR];
+    //position in the house room list
+    int id;
     //linked list initialization
     RoomListType *roomlist; 
     EvidenceListType *evidencelist;
-    //collection of hunters
-    HunterArrayType *hunterArray;
+    //shard holding the number of hunters in the room, and where in its word the count is
+    OccupancyShardType *occupancy;
+    int occupancyShift;
+    //ids of the hunters in the room, into the house's hunter array, changed with the count under the shard's semaphore
+    unsigned char *occupants;
+    int numOccupants;
     //pointer to ghost 
     GhostType *ghost;
 
@@ -59,7 +163,17 @@ struct Ghost {
   GhostClass ghostType;
   RoomType *room;
   int boredomTime;
-  
+  //seqlock over room and boredomTime, odd while the ghost is changing them
+  unsigned int version;
+  //one bit per EvidenceType the ghost has left so far, only the ghost's own turns touch it
+  int dropped;
+};
+
+//a consistent copy of what other threads can see of the ghost
+struct GhostView {
+  GhostClass ghostType;
+  RoomType *room;
+  int boredomTime;
 };
 
 struct RoomNode {
@@ -81,33 +195,123 @@ struct RoomList {
     HunterArrayType* hunterArray;
     EvidenceArrayType* evidenceArray;
     int hunterCount;
+    //distances between rooms, built once the rooms are connected
+    RoomIndexType* index;
+    //rooms holding each type of evidence, NULL until a game starts
+    EvidenceIndexType* evidenceIndex;
+    //block the rooms were copied into from a template, NULL if they were built one by one
+    void* block;
+    //bytes of the block if it came from allocOnNode, 0 if it came from the heap
+    size_t blockMapped;
+    //C_TRUE if the hunters' visited flags were moved onto their nodes by moveToNode
+    int visitedMapped;
+    //hunter counts of the rooms and the block their hunter ids live in, NULL until a game starts
+    OccupancyShardType* occupancy;
+    int numShards;
+    unsigned char* occupants;
+
+};
+
+//a house built once, every game copies its rooms from the image and shares its distances
+struct HouseTemplate {
+    //rooms, room lists and evidence lists ready to play in, pointing into the image itself
+    char *image;
+    size_t size;
+    //distances between rooms, never written once built
+    RoomIndexType *index;
+    //where the parts of the image start
+    size_t listOffset;
+    size_t roomsOffset;
+    size_t roomListsOffset;
+    size_t nodesOffset;
+    size_t evidenceOffset;
+    size_t indexOffset;
+    int numRooms;
+    int numNodes;
+};
 
+//rooms by id and the distances between them
+struct RoomIndex {
+    int numRooms;
+    RoomType **rooms;
+    //moves from each room to the Van
+    int *vanDistance;
+    //numRooms * numRooms distances for small houses, NULL for big ones
+    int *distances;
+    //numLandmarks * numRooms distances from the landmarks for big houses, NULL for small ones
+    int numLandmarks;
+    int *landmarkDistances;
 };
+//evidence in a fading room, gone once virtual time reaches expires
+struct EvidenceEntry {
+    EvidenceType evidence;
+    long expires;
+};
+
+struct EvidenceNode {
+    enum EvidenceType evidence;
+    struct EvidenceNode *next;
+} ;
+
 //build linked list evidence list
 struct EvidenceList {
   //linked list initialization
   EvidenceNodeType *ehead;
   EvidenceNodeType *etail;
+    //the list links at most one node per type, taken from this pool
+    EvidenceNodeType nodes[EV_COUNT];
+    unsigned char listed[EV_COUNT];
+    //ring used instead of the linked list when fadeTime is set
+    long fadeTime;
+    EvidenceEntryType ring[EVIDENCE_RING_SIZE];
+    int start;
+    int count;
+    //house wide index told about every change, NULL if there isn't one
+    EvidenceIndexType *index;
+    int roomId;
     //semaphore 
     sem_t sem;
 } ;
 
-struct EvidenceNode {
-    enum EvidenceType evidence;
-    struct EvidenceNode *next;
-} ;
+//which rooms hold each type of evidence, one semaphore per type
+struct EvidenceIndex {
+    int numRooms;
+    //evidence list of each room, so faded pieces can be dropped before answering, and whether any of them fade
+    EvidenceListType **lists;
+    int fades;
+    int *pieces[EV_COUNT];
+    int *rooms[EV_COUNT];
+    int *position[EV_COUNT];
+    int size[EV_COUNT];
+    sem_t sem[EV_COUNT];
+};
 
-//hunter struct
+//hunter struct, each hunter's thread writes its own cache line and never a neighbour's
 struct Hunter {
+    //read mostly once the game has started
+    //index in the house's hunter array
+    int id;
     char name[MAX_STR];
     EvidenceType equipment;
     //evidence list
     EvidenceArrayType *evidenceArray; 
-    int fear;
+    pthread_t thread;
+    //one flag per room id, used by the frontier policy, at the head of a block of frontierSize bytes that also
+    //holds the scratch arrays of its searches
+    unsigned char *visited;
+    //why and when (in ghost updates) the hunter left, LOG_UNKNOWN while it is still in the house
+    enum LoggerDetails exitReason;
+    long exitTime;
+
+    //rewritten every update, slot is where the hunter sits in its room's occupants, -1 once it has left the house
+    int fear __attribute__((aligned(CACHE_LINE)));
     int boredom;
+    int slot;
     RoomType *room;
-    pthread_t thread;
-} ;
+    //rooms not searched yet in the current sweep and the mark of the last search, for the frontier policy
+    int unvisited;
+    int searchMark;
+} __attribute__((aligned(CACHE_LINE)));
 
 struct EvidenceArray {
     EvidenceType *evidence;
@@ -133,27 +337,331 @@ typedef struct GhostBehaviorContext {
     int numHunters;
     HouseType* house;
     SharedGameState *sharedState;  // Pointer to the shared game state
+    PacerType *pacer;              // Deadlines of the ghost's turns, NULL when it just sleeps between them
 
 } GhostBehaviorContext;
 
 typedef struct HunterBehaviorContext {
+    int id;                        // Agent id of this hunter, 1 to NUM_HUNTERS
     HunterType *hunter;            // Pointer to this hunter's data
     GhostType *ghosts;             // Pointer to the ghosts, if hunters need to interact with or detect ghosts
     HouseType *house;              // Pointer to the house layout
     EvidenceArrayType *sharedEvidence; // Pointer to a shared evidence array          
     HunterArrayType *allHunters;        // Pointer to an array of all hunters, if interaction between hunters is required
     SharedGameState *sharedState;  // Pointer to the shared game state
+    PacerType *pacer;              // Deadlines of the hunter's turns, NULL when it just sleeps between them
 
 } HunterBehaviorContext;
 
 struct sharedState{
     int gameOver;
+    //virtual time, counted in ghost updates
+    long clock;
+    //clock when the first evidence was collected, -1 until then
+    long firstEvidence;
+    //how hunters pick the room to move to
+    HunterPolicy hunterPolicy;
+    //live counters, NULL when they aren't being published
+    StatsType *stats;
+    //every agent seeds its random numbers from this
+    unsigned int seed;
+};
+
+//everything one game is played with, set up by setupGame
+struct Game {
+    HouseType house;
+    GhostType *ghost;
+    SharedGameState state;
+};
+
+//an agent suspended between turns, all it needs to carry on is in its context
+struct Agent {
+    AgentType *next;
+    //takes one turn, returns C_FALSE once the agent is done
+    int (*step)(void *context);
+    void *context;
+    //tick it wakes up in
+    long expires;
+    //the agent's random state, swapped in while it takes its turn
+    unsigned int seed;
+    //ticks it waits between turns
+    int wait;
+    //run on the agent's worker once it is done, NULL for none
+    void (*finished)(AgentType *agent, SchedulerType *scheduler);
+    //whatever the finished hook needs to find, NULL for none
+    void *owner;
+};
+
+//agents waiting to wake up, level n has WHEEL_SLOTS slots of WHEEL_SLOTS^n ticks each
+struct TimerWheel {
+    AgentType *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    long now;
+    int numTimers;
+};
+
+//one worker thread's agents and the wheel they wait on, ticks are simulated time
+struct Scheduler {
+    TimerWheelType wheel;
+    pthread_t thread;
+    //turns taken so far
+    long turns;
+    //posted to run the agents, the worker posts done once they have all finished
+    sem_t start;
+    sem_t *done;
+    int stopping;
+};
+
+//one game played by the scheduler, its agents' whole state lives here instead of on thread stacks
+struct CoopGame {
+    GameType game;
+    GhostBehaviorContext ghostContext;
+    HunterBehaviorContext hunterContexts[NUM_HUNTERS];
+    AgentType agents[NUM_HUNTERS + 1];
+};
+
+//worker threads kept waiting between runs of games, one scheduler each
+struct WorkerPool {
+    SchedulerType *schedulers;
+    int numThreads;
+    sem_t done;
+};
+
+//a point in a game to branch it at
+struct BranchPoint {
+    //returns C_TRUE once the game has got to the point, checked after every tick
+    int (*reached)(BranchPointType *point);
+    //what the point is, for the report
+    const char *name;
+    //the game played to the point, set by runBranches
+    GameType *game;
+    //clock to pause at, for a point in time
+    long clock;
+};
+
+//text a thread's turns print, kept apart per game so it can be printed in game order once the turns are done
+struct TurnOutput {
+    char *text;
+    size_t used;
+    //end of the space the game being played may fill
+    size_t limit;
+    //C_TRUE if some of that game's text didn't fit
+    int cut;
+    //records of each category that game has seen, so its log is sampled the same whoever plays it
+    unsigned long *logCounts;
+};
+
+//counts of values in buckets a 1 / 2^SKETCH_SUB_BITS share wide, so percentiles of any number of values fit in
+//the same memory and two sketches merge by adding their buckets
+struct Sketch {
+    long count;
+    long sum;
+    long min;
+    long max;
+    uint64_t buckets[SKETCH_BUCKETS];
+};
+
+//a sketch of every GameMeasure of a run of games
+struct GameSketch {
+    SketchType measures[MEASURE_COUNT];
+};
+
+//an agent's absolute deadlines in real time and how late its turns started
+struct Pacer {
+    //when the next turn is due
+    struct timespec deadline;
+    //nanoseconds before the deadline spent spinning, 0 to only sleep
+    long spin;
+    long turns;
+    long maxLateness;
+    //turns by how many microseconds late they started, the last bucket holds everything later
+    unsigned int lateness[PACER_BUCKETS];
+};
+
+//thread and memory placement on the machine
+struct Placement {
+    int enabled;
+    //ids of the cpus the process may run on, worker i goes on cores[i % numCores]
+    int cores[MAX_CORES];
+    int numCores;
+    //ids of the online NUMA nodes, not always 0 to numNodes - 1
+    int nodes[MAX_NODES];
+    int numNodes;
+};
+
+//header of the shared memory segment read by fpstat, guarded by a seqlock on sequence, followed by maxRooms room
+//names and then maxRooms dwell counters
+struct LiveStats {
+    unsigned int sequence;
+    long gamesCompleted;
+    long wins[RESULT_COUNT];
+    int activeHunters;
+    //rooms the segment has room for, fixed when it is created, and rooms labelled so far
+    int maxRooms;
+    int numRooms;
+    //most rooms any house played had, rooms past maxRooms aren't counted
+    int roomsPlayed;
+    long evidenceCollected;
+    long updates;
+    double updatesPerSec;
+};
+
+//size of a stats segment and where its per room tables start
+#define STATS_SEGMENT_SIZE(maxRooms)    (sizeof(LiveStatsType) + (size_t)(maxRooms) * (MAX_STR + sizeof(long)))
+#define STATS_ROOM_NAMES(live)          ((char (*)[MAX_STR])((char *)(live) + sizeof(LiveStatsType)))
+#define STATS_ROOM_DWELL(live)          ((long *)((char *)(live) + sizeof(LiveStatsType) + (size_t)(live)->maxRooms * MAX_STR))
+
+//counters updated by the simulation threads and copied into the segment by the publisher thread
+struct Stats {
+    long gamesCompleted;
+    long wins[RESULT_COUNT];
+    int activeHunters;
+    //room names by id, only written under roomsLock, which the publisher holds while it copies them
+    int maxRooms;
+    int numRooms;
+    int roomsPlayed;
+    char (*roomNames)[MAX_STR];
+    sem_t roomsLock;
+    long *roomDwell;
+    long evidenceCollected;
+    long updates;
+    //publisher state
+    LiveStatsType *live;
+    pthread_t publisher;
+    int running;
+    struct timespec lastPublish;
+    long lastUpdates;
+};
+
+//compressed sparse row matrix
+struct SparseMatrix {
+    int rows;
+    int nonZeros;
+    int *rowStart;
+    int *column;
+    double *value;
+};
+
+//transition model of the party game solved by the analytic mode, stepping from one party turn to the next
+struct MarkovModel {
+    //room connections by room id
+    int numRooms;
+    int degree[MAX_ROOMS];
+    int neighbours[MAX_ROOMS][MAX_ROOMS];
+    //ghost updates a piece of evidence lasts, and the ghost updates before the party turn that ends each phase
+    long fadeTime;
+    int gap[MARKOV_PHASES];
+    //by phase, party room and ghost room at its start: the chance the ghost first finds the party before each of
+    //the phase's ghost updates, and the chance it ends the phase in each room without having found it
+    double *meet;
+    double *walk;
+    //chance of each mask of the ghost's evidence types being left over a number of ghost updates
+    double evidenceOdds[MARKOV_MAX_GAP + 1][1 << MAX_EVIDENCE];
+    //reachable states, stateIndex maps a packed state to its row and stateCode maps back
+    int *stateIndex;
+    int *stateCode;
+    int numStates;
+    int stateCapacity;
+    int numStarts;
+    //transitions between states, the one step chance of each ending and, per row, the ghost updates of the step,
+    //the mean and mean square of the ghost updates it takes counting the steps that end the game
+    SparseMatrixType transitions;
+    double *absorb[RESULT_COUNT];
+    int *rowGap;
+    double *updates;
+    double *squares;
+    //rows in the order they are solved, a level at a time, each level only leading to the levels before it
+    int *order;
+    int *levelStart;
+    int numLevels;
+    //solver state, per row the chance of each ending followed by the first two moments of the game's remaining length
+    double *solution;
+    int numWorkers;
+    pthread_barrier_t barrier;
+};
+
+//one finished game, stored one column per field so a column of many games can be scanned on its own
+struct ResultRecord {
+    //options the game was played with
+    int32_t numRooms;
+    uint8_t hunterPolicy;
+    int64_t fadeTime;
+    uint32_t seed;
+    //GameResult, the ghost's GhostClass and the GhostClass the evidence pointed to
+    uint8_t winner;
+    uint8_t ghostClass;
+    uint8_t identified;
+    //length and exit times in ghost updates, exit reasons are enum LoggerDetails
+    int64_t length;
+    uint8_t exitReason[NUM_HUNTERS];
+    int64_t exitTime[NUM_HUNTERS];
+    //one bit per EvidenceType collected
+    uint8_t evidence;
+};
+
+//a results file is a run of blocks of up to RESULTS_BLOCK_GAMES games, each block holding its columns
+//one after the other padded to 8 bytes, then an index of the blocks, the width of each column and a trailer
+struct ResultsBlock {
+    int64_t offset;
+    int32_t numGames;
+    int32_t reserved;
+};
+
+//last bytes of a results file
+struct ResultsTrailer {
+    uint32_t magic;
+    int32_t numColumns;
+    int32_t numBlocks;
+    int32_t reserved;
+    int64_t indexOffset;
+    int64_t numGames;
+};
+
+//a results file being appended to, the games of the current block are buffered column by column
+struct ResultsWriter {
+    FILE *file;
+    //records kept in memory instead of a file, NULL for a file
+    ResultRecordType *records;
+    int64_t capacity;
+    //games can be finished on several workers at once
+    sem_t lock;
+    int64_t numGames;
+    int numBlocks;
+    int blockCapacity;
+    ResultsBlockType *blocks;
+    int blockGames;
+    uint8_t *columns[RESULT_COLUMNS];
+};
+
+//options shared by every game of a run
+struct SimConfig {
+    PlacementType placement;
+    StatsType *stats;
+    HunterPolicy hunterPolicy;
+    //rooms of a generated house, 0 for the default house
+    int numRooms;
+    //ghost updates evidence lasts for, 0 if it never fades
+    long fadeTime;
+    //NUMA node the house of each game is placed on when pinning
+    int node;
+    //seed of the next game
+    unsigned int seed;
+    //results file every finished game is appended to, NULL if there isn't one
+    ResultsWriterType *results;
+    //NUM_HUNTERS + 1 pacers, the ghost's first, NULL if turns aren't paced on deadlines
+    PacerType *pacers;
+    //the default house every game copies, NULL to build each house from scratch
+    HouseTemplateType *house;
+    //sketches every finished game is counted in, NULL if there aren't any, only one thread may finish games into it
+    GameSketchType *sketch;
 };
 
 
 // Helper Utilies
 int randInt(int,int);        // Pseudo-random number generator function
 float randFloat(float, float);  // Pseudo-random float generator function
+void seedRandom(unsigned int seed);  // Seeds the calling thread's random numbers
+unsigned int agentSeed(unsigned int gameSeed, int agent);  // Seed of one agent in a game
+void swapRandomState(unsigned int *state);  // Swaps the calling thread's random state with an agent's
 enum GhostClass randomGhost();  // Return a randomly selected a ghost type
 void ghostToString(enum GhostClass, char*); // Convert a ghost type to a string, stored in output paremeter
 void evidenceToString(enum EvidenceType, char*); // Convert an evidence type to a string, stored in output parameter
@@ -164,47 +672,77 @@ void l_hunterMove(char* name, char* room);
 void l_hunterReview(char* name, enum LoggerDetails reviewResult);
 void l_hunterCollect(char* name, enum EvidenceType evidence, char* room);
 void l_hunterExit(char* name, enum LoggerDetails reason);
+void l_hunterCollectFailed(char* name);
+void l_evidenceFull(void);
+void l_ghostIdentified(enum GhostClass identified, int correct);
 void l_ghostInit(enum GhostClass type, char* room);
 void l_ghostMove(char* room);
 void l_ghostEvidence(enum EvidenceType evidence, char* room);
 void l_ghostExit(enum LoggerDetails reason);
+void l_placement(char* name, int core, int node);
+int logSampled(enum LogCategory category);
+int setLogFilter(const char *spec);
+void setTurnOutput(TurnOutputType *output);
+void printTurn(const char *format, ...) __attribute__((format(printf, 1, 2)));
 
 //house functions
 void initHouse(HouseType *house);
 void populateRooms(HouseType* house);
+void generateRooms(HouseType* house, int numRooms);
 void freeHouse(HouseType *house);
+HouseTemplateType *createHouseTemplate(int numRooms);
+void cloneHouse(HouseType *house, HouseTemplateType *houseTemplate, PlacementType *placement, int node);
+void recloneHouse(HouseType *house, HouseTemplateType *houseTemplate);
+void freeHouseTemplate(HouseTemplateType *houseTemplate);
 
 
 //evidence list functions
 void initEvidenceList(EvidenceListType *list);
 void initEvidence(EvidenceType *evidence, enum EvidenceType type);
 void initEvidenceArray(EvidenceArrayType *evidenceArray, int size);
-EvidenceType addEvidence(GhostType* ghost);
+void setEvidenceFadeTime(EvidenceListType *evidenceList, long fadeTime);
+EvidenceType addEvidence(GhostType* ghost, long now);
+GhostClass identifyGhost(EvidenceArrayType *evidenceArray);
 int reviewEvidence(EvidenceArrayType *evidenceArray, GhostType *ghost);
-EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment);
+EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment, long now);
+void takeEvidence(RoomType *room, EvidenceType evidence, long now);
 int collectEvidence(EvidenceArrayType *evidenceArray, EvidenceType evidence);
 void freeEvidenceList(EvidenceListType *evidenceList);
 void freeEvidenceArray(EvidenceArrayType *evidenceArray);
+EvidenceIndexType *createEvidenceIndex(int numRooms);
+void clearEvidenceIndex(EvidenceIndexType *index);
+void attachEvidenceIndex(EvidenceListType *evidenceList, EvidenceIndexType *index, int roomId);
+void indexEvidence(EvidenceListType *evidenceList, EvidenceType evidence, int change);
+int countRoomsWithEvidence(EvidenceIndexType *index, EvidenceType evidence, long now);
+int hasEvidence(EvidenceIndexType *index, int roomId, EvidenceType evidence, long now);
+int findRoomsWithEvidence(EvidenceIndexType *index, EvidenceType evidence, int *rooms, int maxRooms, long now);
+void freeEvidenceIndex(EvidenceIndexType *index);
 
 //hunter functions
 void initHunterArray(HunterArrayType *hunterArray, int size);
-void initHunter(HunterType *hunter, const char *name, EvidenceType equipment, RoomType *room); 
-int isHunterPresent(GhostType* ghost, HunterArrayType* list);
+void initHunter(HunterType *hunter, int id, const char *name, EvidenceType equipment, RoomType *room); 
+int isHunterPresent(GhostType* ghost);
 void *hunterBehav(void *param);
+int stepHunter(HunterBehaviorContext *context);
 int addHunter(HunterArrayType *hunterArray, const HunterType *newHunter);
 void moveToRandomRoomHunter(HunterType *hunter, HouseType *house);
-void updateHunterState(HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState); 
+void moveToFrontierRoomHunter(HunterType *hunter, HouseType *house);
+void moveToEvidenceRoomHunter(HunterType *hunter, HouseType *house, long now);
+int updateHunterState(HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState); 
+int updatePartyState(HunterType *leader, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState);
 void assignRandomEquipment(HunterArrayType* hunters, int numHunters);
-void removeHunter(HunterArrayType *hunters_list, HunterType* hunter);
 void clearHunterArray(HunterArrayType *hunterArray);
-void initHunterBehaviorContext(HunterBehaviorContext *context, HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState); 
+void initHunterBehaviorContext(HunterBehaviorContext *context, int id, HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState); 
 void freeHunter(HunterType* hunter);
 void freeHunterArray(HunterArrayType *hunterArray);
 
 //ghost functions 
 void initGhost(GhostType *ghost, enum GhostClass type, RoomType *room);
+void publishGhost(GhostType *ghost, RoomType *room, int boredomTime);
+void readGhost(GhostType *ghost, GhostViewType *view);
 void *ghostBehav(void *param);
-void updateGhostState(GhostType *ghost, HunterArrayType *hunters, SharedGameState *sharedState); 
+int stepGhost(GhostBehaviorContext *context);
+int updateGhostState(GhostType *ghost, SharedGameState *sharedState); 
 int isGhostPresent(GhostType* ghost, HunterType *hunter);
 void moveToRandomRoomGhost(GhostType *ghost);
 void freeGhost(GhostType *ghost);
@@ -220,4 +758,130 @@ RoomType* getRandomRoom(HouseType *house);
 void freeRoom(RoomType *room); 
 void freeRoomListHouse(RoomListType *roomList);
 void freeRoomList(RoomListType *roomList);
-RoomType* getRandomRoomExcludeVan(HouseType *house); 
\ No newline at end of file
+RoomType* getRandomRoomExcludeVan(HouseType *house);
+void createOccupancy(HouseType *house, int maxHunters);
+void resetOccupancy(HouseType *house, int maxHunters);
+void freeOccupancy(HouseType *house);
+void addOccupant(RoomType *room, HunterType *hunter);
+void removeOccupant(HunterType *hunter, HunterType *allHunters);
+void moveOccupant(HunterType *hunter, RoomType *to, HunterType *allHunters);
+int countOccupants(RoomType *room);
+void readOccupants(RoomType *room1, RoomType *room2, int *count1, int *count2);
+
+//placement functions
+void initPlacement(PlacementType *placement, int enabled);
+int getCoreNode(PlacementType *placement, int core);
+int getWorkerCore(PlacementType *placement, int worker);
+int placesMemory(PlacementType *placement);
+int createPinnedThread(PlacementType *placement, pthread_t *thread, int core, void *(*start)(void *), void *arg);
+void *allocOnNode(PlacementType *placement, size_t size, int node);
+void freeOnNode(void *memory, size_t size);
+void *moveToNode(PlacementType *placement, void *memory, size_t size, int node);
+
+//game functions
+void setupGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR]);
+void resetGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR]);
+GameResult runGame(SimConfigType *config, char hunterNames[][MAX_STR]);
+GameResult scoreGame(GameType *game, SimConfigType *config);
+GameResult finishGame(GameType *game, SimConfigType *config);
+void freeGame(GameType *game);
+
+//city functions
+void runCity(SimConfigType *config, char hunterNames[][MAX_STR], int numHouses, int gamesPerHouse, WorkerPoolType *pool, int wins[]);
+
+//daemon functions
+int runDaemon(SimConfigType *config, const char *path, int numThreads);
+
+//coordinator functions
+int runCoordinator(SimConfigType *config, char hunterNames[][MAX_STR], int games, int numWorkers, int wins[]);
+
+//lockstep functions
+void runLockstep(SimConfigType *config, char hunterNames[][MAX_STR], int games, int numThreads, int wins[]);
+
+//branching functions
+int parseBranchPoint(const char *spec, BranchPointType *point);
+int runBranches(SimConfigType *config, char hunterNames[][MAX_STR], BranchPointType *point, int branches, int numProcs, int wins[]);
+
+//sketch functions
+void initSketch(SketchType *sketch);
+void addToSketch(SketchType *sketch, long value);
+void mergeSketch(SketchType *into, SketchType *from);
+long sketchQuantile(SketchType *sketch, double quantile);
+void initGameSketch(GameSketchType *sketch);
+void recordGameSketch(GameSketchType *sketch, GameType *game);
+void mergeGameSketch(GameSketchType *into, GameSketchType *from);
+void printGameSketch(GameSketchType *sketch);
+
+//pacing functions
+void initPacer(PacerType *pacer, long spinTime);
+void startPacer(PacerType *pacer);
+void waitTurn(PacerType *pacer, long wait);
+void printPacingReport(PacerType pacers[], char hunterNames[][MAX_STR]);
+
+//cooperative scheduler functions
+void initTimerWheel(TimerWheelType *wheel);
+void addTimer(TimerWheelType *wheel, AgentType *agent, long delay);
+AgentType *advanceTimerWheel(TimerWheelType *wheel);
+void initScheduler(SchedulerType *scheduler);
+void addAgent(SchedulerType *scheduler, AgentType *agent);
+void startWorkerPool(WorkerPoolType *pool, int numThreads, PlacementType *placement);
+void runWorkerPool(WorkerPoolType *pool);
+void stopWorkerPool(WorkerPoolType *pool);
+int runTurnsUntil(SchedulerType *scheduler, int (*pause)(void *arg), void *arg);
+void initCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR]);
+void startCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR], SchedulerType *scheduler);
+void restartCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR], SchedulerType *scheduler);
+void runCoopGames(SimConfigType *config, char hunterNames[][MAX_STR], int games, WorkerPoolType *pool, int wins[], FILE *stream, FILE *summary);
+
+//live stats functions
+StatsType *openStats(int maxRooms);
+void closeStats(StatsType *stats);
+void setStatsRooms(StatsType *stats, HouseType *house);
+void countUpdate(StatsType *stats);
+void countGhostDwell(StatsType *stats, RoomType *room);
+void countEvidence(StatsType *stats);
+void countActiveHunters(StatsType *stats, int change);
+void recordGame(StatsType *stats, GameResult result);
+
+//results store functions
+ResultsWriterType *openResults(const char *path);
+ResultsWriterType *openMemoryResults(ResultRecordType *records, int64_t capacity, int64_t numGames);
+void appendResult(ResultsWriterType *writer, ResultRecordType *record);
+void closeResults(ResultsWriterType *writer);
+
+//benchmark functions
+void runScalingBenchmark(PlacementType *placement);
+void runGhostReadBenchmark(PlacementType *placement);
+void runDoorwayBenchmark(PlacementType *placement);
+void runEvidenceIndexBenchmark();
+
+//allocation guard functions
+void setAllocPhase(AllocPhase phase);
+int checkAllocations();
+
+//record and replay functions
+int openRecording(const char *path, SimConfigType *config, char hunterNames[][MAX_STR]);
+int openReplay(const char *path, SimConfigType *config, char hunterNames[][MAX_STR]);
+void closeRecording();
+int isReplaying();
+int moreReplayGames();
+int recordRandom(int value);
+void beginStep(int agent);
+void endStep();
+void endGameRecord();
+void replayGame(GhostBehaviorContext *ghostContext, HunterBehaviorContext *hunterContexts[]);
+
+//analytic solver functions
+void initMarkovModel(MarkovModelType *model, HouseType *house, long fadeTime);
+void buildMarkovModel(MarkovModelType *model);
+void solveMarkovModel(MarkovModelType *model, int numThreads, double winProb[], double *expectedLength, double *lengthDeviation);
+void freeMarkovModel(MarkovModelType *model);
+
+//pathing functions
+void buildRoomIndex(HouseType *house);
+int roomDistance(RoomIndexType *index, int from, int to);
+size_t frontierSize(int numRooms);
+void visitRoom(HunterType *hunter, int room);
+RoomType *chooseFrontierRoom(RoomIndexType *index, HunterType *hunter);
+RoomType *chooseEvidenceRoom(RoomIndexType *index, EvidenceIndexType *evidenceIndex, HunterType *hunter, long now);
+void freeRoomIndex(RoomIndexType *index);
@@ -32,16 +32,59 @@ void initEvidenceList(EvidenceListType *evidenceList)
     // co pilot was used to write this code
     evidenceList->ehead = NULL;
     evidenceList->etail = NULL;
+    memset(evidenceList->listed, 0, sizeof(evidenceList->listed));
+    // Evidence never fades until setEvidenceFadeTime is called
+    evidenceList->fadeTime = 0;
+    evidenceList->start = 0;
+    evidenceList->count = 0;
+    // Not tracked by a house wide index until attachEvidenceIndex is called
+    evidenceList->index = NULL;
+    evidenceList->roomId = -1;
     sem_init(&evidenceList->sem, 0, 1);
 }
 
 /*
-Function: EvidenceType addEvidence(GhostType *ghost)
+Function: void setEvidenceFadeTime(EvidenceListType *evidenceList, long fadeTime)
+Purpose: Switches an evidence list to a fixed size ring where evidence fades after a number of ghost updates.
+in/out: evidenceList - Pointer to an EvidenceListType structure, must still be empty, its index is told it fades
+in: fadeTime - Number of ghost updates a piece of evidence lasts, 0 keeps the unbounded list
+return: nothing is being returned
+*/
+void setEvidenceFadeTime(EvidenceListType *evidenceList, long fadeTime)
+{
+    evidenceList->fadeTime = fadeTime;
+    if (evidenceList->index != NULL && fadeTime > 0)
+    {
+        evidenceList->index->fades = C_TRUE;
+    }
+}
+
+/*
+Function: void expireEvidence(EvidenceListType *evidenceList, long now)
+Purpose: Drops the evidence that has faded from the front of the ring, the caller must hold the list's semaphore.
+in/out: evidenceList - Pointer to an EvidenceListType structure in ring mode
+in: now - The current virtual time in ghost updates
+return: nothing is being returned
+*/
+static void expireEvidence(EvidenceListType *evidenceList, long now)
+{
+    // Every piece lasts the same time, so the oldest is always at the front
+    while (evidenceList->count > 0 && evidenceList->ring[evidenceList->start].expires <= now)
+    {
+        indexEvidence(evidenceList, evidenceList->ring[evidenceList->start].evidence, -1);
+        evidenceList->start = (evidenceList->start + 1) % EVIDENCE_RING_SIZE;
+        evidenceList->count--;
+    }
+}
+
+/*
+Function: EvidenceType addEvidence(GhostType *ghost, long now)
 Purpose: Generates and adds evidence to the evidence list of a room based on the ghost's type.
 in: ghost - Pointer to the GhostType structure representing the ghost
+in: now - The current virtual time in ghost updates, used when evidence fades
 out: Returns the type of evidence added to the room
 */
-EvidenceType addEvidence(GhostType *ghost)
+EvidenceType addEvidence(GhostType *ghost, long now)
 {
     if (ghost == NULL || ghost->room == NULL || ghost->room->evidencelist == NULL)
     {
@@ -121,32 +164,54 @@ EvidenceType addEvidence(GhostType *ghost)
         return evidenceToAdd;
     }
 
-    // Create a new evidence node
-    EvidenceNodeType *newNode = malloc(sizeof(EvidenceNodeType));
-    if (newNode == NULL)
+    // A fading list keeps the evidence in its ring, the oldest piece making way when it is full
+    EvidenceListType *evidenceList = ghost->room->evidencelist;
+    if (evidenceList->fadeTime > 0)
     {
-        printf("Error allocating memory for evidence node\n");
-        exit(1);
+        sem_wait(&evidenceList->sem);
+        expireEvidence(evidenceList, now);
+        if (evidenceList->count == EVIDENCE_RING_SIZE)
+        {
+            indexEvidence(evidenceList, evidenceList->ring[evidenceList->start].evidence, -1);
+            evidenceList->start = (evidenceList->start + 1) % EVIDENCE_RING_SIZE;
+            evidenceList->count--;
+        }
+        int slot = (evidenceList->start + evidenceList->count) % EVIDENCE_RING_SIZE;
+        evidenceList->ring[slot].evidence = evidenceToAdd;
+        evidenceList->ring[slot].expires = now + evidenceList->fadeTime;
+        evidenceList->count++;
+        indexEvidence(evidenceList, evidenceToAdd, 1);
+        sem_post(&evidenceList->sem);
+        return evidenceToAdd;
     }
-    // lock the evidence list
-    sem_wait(&ghost->room->evidencelist->sem);
-    newNode->evidence = evidenceToAdd;
-    newNode->next = NULL;
 
-    //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
-    // co pilot was used to write this code
-    if (ghost->room->evidencelist->ehead == NULL)
-    {
-        ghost->room->evidencelist->ehead = newNode;
-        ghost->room->evidencelist->etail = newNode;
-    }
-    else
+    // An unbounded list never loses evidence, so only the first piece of each type changes what
+    // hunters find. Each type links its node from the list's own pool once and later pieces just
+    // count towards the index, keeping the game loop free of allocations.
+    sem_wait(&evidenceList->sem);
+    if (!evidenceList->listed[evidenceToAdd])
     {
-        ghost->room->evidencelist->etail->next = newNode;
-        ghost->room->evidencelist->etail = newNode;
+        EvidenceNodeType *newNode = &evidenceList->nodes[evidenceToAdd];
+        newNode->evidence = evidenceToAdd;
+        newNode->next = NULL;
+
+        //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
+        // co pilot was used to write this code
+        if (evidenceList->ehead == NULL)
+        {
+            evidenceList->ehead = newNode;
+            evidenceList->etail = newNode;
+        }
+        else
+        {
+            evidenceList->etail->next = newNode;
+            evidenceList->etail = newNode;
+        }
+        evidenceList->listed[evidenceToAdd] = C_TRUE;
     }
+    indexEvidence(evidenceList, evidenceToAdd, 1);
     // unlock the evidence list
-    sem_post(&ghost->room->evidencelist->sem);
+    sem_post(&evidenceList->sem);
     return evidenceToAdd;
 }
 
@@ -173,7 +238,7 @@ int collectEvidence(EvidenceArrayType *evidenceArray, EvidenceType evidence)
     // Check if the array has reached its capacity
     if (evidenceArray->size >= MAX_EVIDENCE)
     {
-        printf("Error: Evidence array is full\n");
+        LOG_IF(LOG_CAT_EVIDENCE, l_evidenceFull());
         return 0;
     }
 
@@ -199,19 +264,39 @@ int collectEvidence(EvidenceArrayType *evidenceArray, EvidenceType evidence)
 }
 
 /*
-Function: EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment)
+Function: EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment, long now)
 Purpose: Checks if a specific type of evidence is present in the evidence list of a room.
 in: room - Pointer to the RoomType structure representing the room
 in: hunterEquipment - The type of evidence to check for
+in: now - The current virtual time in ghost updates, used when evidence fades
 out: Returns the type of evidence if present, otherwise returns EV_UNKNOWN
 */
-EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment)
+EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment, long now)
 {
     if (room == NULL || room->evidencelist == NULL)
     {
         return 0; // No evidence present
     }
 
+    // A fading list only ever has EVIDENCE_RING_SIZE pieces to look at
+    EvidenceListType *evidenceList = room->evidencelist;
+    if (evidenceList->fadeTime > 0)
+    {
+        EvidenceType found = EV_UNKNOWN;
+        sem_wait(&evidenceList->sem);
+        expireEvidence(evidenceList, now);
+        for (int i = 0; i < evidenceList->count; i++)
+        {
+            if (evidenceList->ring[(evidenceList->start + i) % EVIDENCE_RING_SIZE].evidence == hunterEquipment)
+            {
+                found = hunterEquipment;
+                break;
+            }
+        }
+        sem_post(&evidenceList->sem);
+        return found;
+    }
+
     EvidenceNodeType *current = room->evidencelist->ehead;
     while (current != NULL)
     {
@@ -226,17 +311,52 @@ EvidenceType isEvidencePresent(RoomType *room, EvidenceType hunterEquipment)
 }
 
 /*
-Function: int reviewEvidence(EvidenceArrayType *evidenceArray, GhostType *ghost)
-Purpose: Reviews the collected evidence and attempts to identify the ghost type.
+Function: void takeEvidence(RoomType *room, EvidenceType evidence, long now)
+Purpose: Removes the oldest piece of a type of evidence from a fading room once a hunter has picked it up.
+         Evidence in an unbounded list is left where it is.
+in/out: room - Pointer to the RoomType structure representing the room
+in: evidence - The type of evidence picked up
+in: now - The current virtual time in ghost updates
+return: nothing is being returned
+*/
+void takeEvidence(RoomType *room, EvidenceType evidence, long now)
+{
+    if (room == NULL || room->evidencelist == NULL || room->evidencelist->fadeTime == 0)
+    {
+        return;
+    }
+
+    EvidenceListType *evidenceList = room->evidencelist;
+    sem_wait(&evidenceList->sem);
+    expireEvidence(evidenceList, now);
+    for (int i = 0; i < evidenceList->count; i++)
+    {
+        if (evidenceList->ring[(evidenceList->start + i) % EVIDENCE_RING_SIZE].evidence == evidence)
+        {
+            // close the gap by shifting the newer pieces down one slot
+            for (int j = i; j < evidenceList->count - 1; j++)
+            {
+                evidenceList->ring[(evidenceList->start + j) % EVIDENCE_RING_SIZE] = evidenceList->ring[(evidenceList->start + j + 1) % EVIDENCE_RING_SIZE];
+            }
+            evidenceList->count--;
+            indexEvidence(evidenceList, evidence, -1);
+            break;
+        }
+    }
+    sem_post(&evidenceList->sem);
+}
+
+/*
+Function: GhostClass identifyGhost(EvidenceArrayType *evidenceArray)
+Purpose: Works out which ghost the collected evidence points to.
 in: evidenceArray - Pointer to an EvidenceArrayType structure representing the collected evidence array
-in: ghost - Pointer to a GhostType structure to be identified
-return: Returns 1 if the ghost type is correctly identified, 0 otherwise
+return: Returns the ghost class matching the evidence, GH_UNKNOWN unless exactly 3 pieces were collected
 */
-int reviewEvidence(EvidenceArrayType *evidenceArray, GhostType *ghost)
+GhostClass identifyGhost(EvidenceArrayType *evidenceArray)
 {
     if (evidenceArray == NULL || evidenceArray->size != 3)
     {
-        return 0;
+        return GH_UNKNOWN;
     }
 
     // Acquire the semaphore to ensure thread safety
@@ -279,22 +399,28 @@ int reviewEvidence(EvidenceArrayType *evidenceArray, GhostType *ghost)
 
     // Release the semaphore
     sem_post(&evidenceArray->sem);
+    return identifiedGhostType;
+}
 
-    // Check if the identified ghost type matches the actual ghost type
-    char ghostName[MAX_STR];                       // Make sure MAX_STR is defined and large enough
-    ghostToString(identifiedGhostType, ghostName); // Convert identified ghost type to string
-
-    if (identifiedGhostType == ghost->ghostType)
-    {
-        printf("Correctly identified the ghost type as %s!\n", ghostName);
-        return 1;
-    }
-    else
+/*
+Function: int reviewEvidence(EvidenceArrayType *evidenceArray, GhostType *ghost)
+Purpose: Reviews the collected evidence and attempts to identify the ghost type.
+in: evidenceArray - Pointer to an EvidenceArrayType structure representing the collected evidence array
+in: ghost - Pointer to a GhostType structure to be identified
+return: Returns 1 if the ghost type is correctly identified, 0 otherwise
+*/
+int reviewEvidence(EvidenceArrayType *evidenceArray, GhostType *ghost)
+{
+    if (evidenceArray == NULL || evidenceArray->size != 3)
     {
-        printf("Incorrect ghost type. Further investigation needed.\n");
         return 0;
     }
-    return 0;
+    GhostClass identifiedGhostType = identifyGhost(evidenceArray);
+
+    // Check if the identified ghost type matches the actual ghost type, the name is only looked up if it is logged
+    int correct = identifiedGhostType == ghost->ghostType;
+    LOG_IF(LOG_CAT_REVIEW, l_ghostIdentified(identifiedGhostType, correct));
+    return correct;
 }
 
 /*
@@ -330,13 +456,239 @@ void freeEvidenceList(EvidenceListType *evidenceList)
         return;
     }
 
-    EvidenceNodeType *current = evidenceList->ehead;
-    while (current != NULL)
+    // the nodes live in the list itself
+    free(evidenceList); // Free the list
+}
+
+/*
+Function: EvidenceIndexType *createEvidenceIndex(int numRooms)
+Purpose: Creates an empty index of which rooms hold each type of evidence.
+in: numRooms - Number of rooms in the house
+return: Returns a pointer to the new EvidenceIndexType structure
+*/
+EvidenceIndexType *createEvidenceIndex(int numRooms)
+{
+    EvidenceIndexType *index = malloc(sizeof(EvidenceIndexType));
+    if (index == NULL)
     {
-        EvidenceNodeType *temp = current;
-        current = current->next;
-        free(temp); // Free each node
+        printf("Error allocating memory for evidence index\n");
+        exit(1);
     }
 
-    free(evidenceList); // Free the list
-}
\ No newline at end of file
+    index->numRooms = numRooms;
+    for (int type = 0; type < EV_COUNT; type++)
+    {
+        // pieces counts the evidence per room, rooms is the dense set of rooms holding any and
+        // position is where each room sits in that set, -1 when it isn't in it
+        index->pieces[type] = calloc(numRooms, sizeof(int));
+        index->rooms[type] = malloc(numRooms * sizeof(int));
+        index->position[type] = malloc(numRooms * sizeof(int));
+        if (index->pieces[type] == NULL || index->rooms[type] == NULL || index->position[type] == NULL)
+        {
+            printf("Error allocating memory for evidence index\n");
+            exit(1);
+        }
+    }
+    index->lists = calloc(numRooms, sizeof(EvidenceListType *));
+    if (index->lists == NULL)
+    {
+        printf("Error allocating memory for evidence index\n");
+        exit(1);
+    }
+    clearEvidenceIndex(index);
+    return index;
+}
+
+/*
+Function: void clearEvidenceIndex(EvidenceIndexType *index)
+Purpose: Empties an evidence index so it can track the rooms of another game, without allocating.
+in/out: index - Pointer to the EvidenceIndexType structure, its lists are attached again by the caller
+return: nothing is being returned
+*/
+void clearEvidenceIndex(EvidenceIndexType *index)
+{
+    for (int type = 0; type < EV_COUNT; type++)
+    {
+        memset(index->pieces[type], 0, index->numRooms * sizeof(int));
+        memset(index->position[type], -1, index->numRooms * sizeof(int));
+        index->size[type] = 0;
+        sem_init(&index->sem[type], 0, 1);
+    }
+    index->fades = C_FALSE;
+}
+
+/*
+Function: void attachEvidenceIndex(EvidenceListType *evidenceList, EvidenceIndexType *index, int roomId)
+Purpose: Makes a room's evidence list report its evidence to the house wide index.
+in/out: evidenceList - Pointer to an EvidenceListType structure, must still be empty
+in: index - Pointer to the EvidenceIndexType structure of the house
+in: roomId - Id of the room owning the list
+return: nothing is being returned
+*/
+void attachEvidenceIndex(EvidenceListType *evidenceList, EvidenceIndexType *index, int roomId)
+{
+    evidenceList->index = index;
+    evidenceList->roomId = roomId;
+    index->lists[roomId] = evidenceList;
+}
+
+/*
+Function: void indexEvidence(EvidenceListType *evidenceList, EvidenceType evidence, int change)
+Purpose: Records evidence appearing in or leaving a room, adding or removing the room from the type's set
+         when its first piece arrives or its last piece goes. The caller holds the list's semaphore.
+in: evidenceList - Pointer to the EvidenceListType structure that changed
+in: evidence - The type of evidence that changed
+in: change - 1 for a new piece, -1 for a piece that is gone
+return: nothing is being returned
+*/
+void indexEvidence(EvidenceListType *evidenceList, EvidenceType evidence, int change)
+{
+    EvidenceIndexType *index = evidenceList->index;
+    if (index == NULL || evidence < EMF || evidence >= EV_COUNT)
+    {
+        return;
+    }
+
+    int room = evidenceList->roomId;
+    sem_wait(&index->sem[evidence]);
+    index->pieces[evidence][room] += change;
+    if (index->pieces[evidence][room] > 0 && index->position[evidence][room] < 0)
+    {
+        index->position[evidence][room] = index->size[evidence];
+        index->rooms[evidence][index->size[evidence]++] = room;
+    }
+    else if (index->pieces[evidence][room] == 0 && index->position[evidence][room] >= 0)
+    {
+        // swap the last room into the gap
+        int gap = index->position[evidence][room];
+        int last = index->rooms[evidence][--index->size[evidence]];
+        index->rooms[evidence][gap] = last;
+        index->position[evidence][last] = gap;
+        index->position[evidence][room] = -1;
+    }
+    sem_post(&index->sem[evidence]);
+}
+
+/*
+Function: void expireIndexedRooms(EvidenceIndexType *index, EvidenceType evidence, long now)
+Purpose: Drops the faded evidence of every room the index lists for a type. Pieces only leave a fading ring when
+         its room is touched, so without this the index would keep listing rooms whose evidence is gone. The rooms
+         are walked from the last one down, a room that drops out swaps in a room that has been looked at already.
+in/out: index - Pointer to the EvidenceIndexType structure of the house
+in: evidence - The type of evidence
+in: now - The current virtual time in ghost updates
+return: nothing is being returned
+*/
+static void expireIndexedRooms(EvidenceIndexType *index, EvidenceType evidence, long now)
+{
+    if (!index->fades)
+    {
+        return;
+    }
+    for (int i = __atomic_load_n(&index->size[evidence], __ATOMIC_RELAXED) - 1; i >= 0; i--)
+    {
+        // the list's semaphore is always taken before the index's, so the room is read and let go first
+        sem_wait(&index->sem[evidence]);
+        int room = i < index->size[evidence] ? index->rooms[evidence][i] : -1;
+        sem_post(&index->sem[evidence]);
+        EvidenceListType *evidenceList = room >= 0 ? index->lists[room] : NULL;
+        if (evidenceList != NULL && evidenceList->fadeTime > 0)
+        {
+            sem_wait(&evidenceList->sem);
+            expireEvidence(evidenceList, now);
+            sem_post(&evidenceList->sem);
+        }
+    }
+}
+
+/*
+Function: int countRoomsWithEvidence(EvidenceIndexType *index, EvidenceType evidence, long now)
+Purpose: Counts the rooms currently holding a type of evidence, in O(1) for unbounded lists and O(matches) for
+         fading ones, whose faded pieces are dropped first.
+in: index - Pointer to the EvidenceIndexType structure of the house
+in: evidence - The type of evidence
+in: now - The current virtual time in ghost updates
+return: Returns the number of rooms holding that evidence
+*/
+int countRoomsWithEvidence(EvidenceIndexType *index, EvidenceType evidence, long now)
+{
+    if (evidence < EMF || evidence >= EV_COUNT)
+    {
+        return 0;
+    }
+    expireIndexedRooms(index, evidence, now);
+    return __atomic_load_n(&index->size[evidence], __ATOMIC_RELAXED);
+}
+
+/*
+Function: int hasEvidence(EvidenceIndexType *index, int roomId, EvidenceType evidence, long now)
+Purpose: Checks in O(1) if a room holds a type of evidence that hasn't faded.
+in: index - Pointer to the EvidenceIndexType structure of the house
+in: roomId - Id of the room
+in: evidence - The type of evidence
+in: now - The current virtual time in ghost updates
+return: Returns C_TRUE if the room holds that evidence, C_FALSE otherwise
+*/
+int hasEvidence(EvidenceIndexType *index, int roomId, EvidenceType evidence, long now)
+{
+    if (evidence < EMF || evidence >= EV_COUNT)
+    {
+        return C_FALSE;
+    }
+    EvidenceListType *evidenceList = index->lists[roomId];
+    if (evidenceList != NULL && evidenceList->fadeTime > 0)
+    {
+        sem_wait(&evidenceList->sem);
+        expireEvidence(evidenceList, now);
+        sem_post(&evidenceList->sem);
+    }
+    return __atomic_load_n(&index->pieces[evidence][roomId], __ATOMIC_RELAXED) > 0;
+}
+
+/*
+Function: int findRoomsWithEvidence(EvidenceIndexType *index, EvidenceType evidence, int *rooms, int maxRooms, long now)
+Purpose: Copies the ids of the rooms holding a type of evidence that hasn't faded, in O(matches).
+in: index - Pointer to the EvidenceIndexType structure of the house
+in: evidence - The type of evidence
+out: rooms - Array receiving up to maxRooms room ids
+in: maxRooms - Capacity of the rooms array
+in: now - The current virtual time in ghost updates
+return: Returns the number of room ids copied
+*/
+int findRoomsWithEvidence(EvidenceIndexType *index, EvidenceType evidence, int *rooms, int maxRooms, long now)
+{
+    if (evidence < EMF || evidence >= EV_COUNT)
+    {
+        return 0;
+    }
+
+    expireIndexedRooms(index, evidence, now);
+    sem_wait(&index->sem[evidence]);
+    int found = index->size[evidence] < maxRooms ? index->size[evidence] : maxRooms;
+    memcpy(rooms, index->rooms[evidence], found * sizeof(int));
+    sem_post(&index->sem[evidence]);
+    return found;
+}
+
+/*
+Function: void freeEvidenceIndex(EvidenceIndexType *index)
+Purpose: Frees the memory associated with the evidence index.
+in/out: index - Pointer to the EvidenceIndexType structure to be freed
+return: none
+*/
+void freeEvidenceIndex(EvidenceIndexType *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+    for (int type = 0; type < EV_COUNT; type++)
+    {
+        free(index->pieces[type]);
+        free(index->rooms[type]);
+        free(index->position[type]);
+        sem_destroy(&index->sem[type]);
+    }
+    free(index->lists);
+    free(index);
+}
@@ -0,0 +1,46 @@
+#include "defs.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// sends one job to a running fp --serve and prints the lines it streams back
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Usage: %s SOCKET \"games=N seed=S rooms=R policy=random|frontier fade=F\" (or \"shutdown\")\n", argv[0]);
+        return 1;
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", argv[1]);
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 || connect(server, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        printf("Error: No daemon is listening on %s, start one with fp --serve\n", argv[1]);
+        return 1;
+    }
+
+    // the job is a single line, hanging up the writing side tells the daemon there are no more
+    char request[MAX_STR * 4];
+    int length = snprintf(request, sizeof(request), "%s\n", argv[2]);
+    if (length >= (int)sizeof(request) || write(server, request, length) != length)
+    {
+        printf("Error: Failed to send the job\n");
+        close(server);
+        return 1;
+    }
+    shutdown(server, SHUT_WR);
+
+    int failed = C_FALSE;
+    FILE *replies = fdopen(server, "r");
+    char line[MAX_STR * 4];
+    while (fgets(line, sizeof(line), replies) != NULL)
+    {
+        fputs(line, stdout);
+        failed = failed || strncmp(line, "error", 5) == 0;
+    }
+    fclose(replies);
+    return failed ? 1 : 0;
+}
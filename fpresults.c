@@ -0,0 +1,183 @@
+#include "defs.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// the reader doesn't link the simulator, so it keeps its own copy of the ghost names
+static const char *ghostNames[GHOST_COUNT] = { "Poltergeist", "Banshee", "Bullies", "Phantom" };
+
+// a mapped results file, columns are found through the block index without copying anything
+typedef struct ResultsFile {
+    const uint8_t *data;
+    size_t size;
+    const ResultsTrailerType *trailer;
+    const ResultsBlockType *blocks;
+    const int32_t *widths;
+} ResultsFileType;
+
+/*
+Function: const void *getColumn(ResultsFileType *results, int block, int column)
+Purpose: Finds where a column of a block starts in the mapped file.
+in: results - Pointer to the mapped ResultsFileType
+in: block - Index of the block
+in: column - The column, from enum ResultColumn
+return: Returns a pointer to the first value of the column in the block
+*/
+static const void *getColumn(ResultsFileType *results, int block, int column)
+{
+    size_t offset = results->blocks[block].offset;
+    for (int i = 0; i < column; i++)
+    {
+        // columns are padded out to 8 bytes
+        offset += ((size_t)results->widths[i] * results->blocks[block].numGames + 7) / 8 * 8;
+    }
+    return results->data + offset;
+}
+
+/*
+Function: void printSummary(ResultsFileType *results)
+Purpose: Prints how each ghost class fared over every game in the file, reading only the columns it needs.
+in: results - Pointer to the mapped ResultsFileType
+return: none
+*/
+static void printSummary(ResultsFileType *results)
+{
+    long games[GHOST_COUNT] = {0};
+    long hunterWins[GHOST_COUNT] = {0};
+    long identified[GHOST_COUNT] = {0};
+    long length[GHOST_COUNT] = {0};
+    long exits[LOG_UNKNOWN + 1] = {0};
+
+    for (int block = 0; block < results->trailer->numBlocks; block++)
+    {
+        const uint8_t *ghost = getColumn(results, block, COL_GHOST);
+        const uint8_t *winner = getColumn(results, block, COL_WINNER);
+        const uint8_t *guess = getColumn(results, block, COL_IDENTIFIED);
+        const int64_t *gameLength = getColumn(results, block, COL_LENGTH);
+        const uint8_t *exitReason = getColumn(results, block, COL_EXIT_REASON);
+        for (int i = 0; i < results->blocks[block].numGames; i++)
+        {
+            if (ghost[i] >= GHOST_COUNT)
+            {
+                continue;
+            }
+            games[ghost[i]]++;
+            hunterWins[ghost[i]] += winner[i] == RESULT_HUNTERS_WIN;
+            identified[ghost[i]] += guess[i] == ghost[i];
+            length[ghost[i]] += gameLength[i];
+            for (int hunter = 0; hunter < NUM_HUNTERS; hunter++)
+            {
+                int reason = exitReason[i * NUM_HUNTERS + hunter];
+                exits[reason <= LOG_UNKNOWN ? reason : LOG_UNKNOWN]++;
+            }
+        }
+    }
+
+    printf("%ld games in %d blocks\n", (long)results->trailer->numGames, results->trailer->numBlocks);
+    printf("=================================\n");
+    printf("Ghost            Games   Hunters won   Identified   Mean length\n");
+    for (int ghost = 0; ghost < GHOST_COUNT; ghost++)
+    {
+        long count = games[ghost] > 0 ? games[ghost] : 1;
+        printf("%-12s %9ld %12.1f%% %11.1f%% %13.1f\n", ghostNames[ghost], games[ghost], 100.0 * hunterWins[ghost] / count,
+               100.0 * identified[ghost] / count, (double)length[ghost] / count);
+    }
+    printf("Hunters scared out: %ld, bored out: %ld, left with the evidence: %ld, still in the house: %ld\n",
+           exits[LOG_FEAR], exits[LOG_BORED], exits[LOG_EVIDENCE], exits[LOG_UNKNOWN]);
+}
+
+/*
+Function: void printSeeds(ResultsFileType *results, GameResult winner)
+Purpose: Prints the seed of every game with the given ending, so they can be played again with fp --seed.
+in: results - Pointer to the mapped ResultsFileType
+in: winner - The ending to look for
+return: none
+*/
+static void printSeeds(ResultsFileType *results, GameResult winner)
+{
+    for (int block = 0; block < results->trailer->numBlocks; block++)
+    {
+        const uint8_t *winners = getColumn(results, block, COL_WINNER);
+        const uint32_t *seeds = getColumn(results, block, COL_SEED);
+        for (int i = 0; i < results->blocks[block].numGames; i++)
+        {
+            if (winners[i] == winner)
+            {
+                printf("%u\n", seeds[i]);
+            }
+        }
+    }
+}
+
+// summarises a results file written by fp --results, or lists the seeds of the games with one ending
+int main(int argc, char *argv[])
+{
+    int listSeeds = C_FALSE;
+    GameResult winner = RESULT_HUNTERS_WIN;
+    int valid = argc == 2;
+    if (argc == 4 && strcmp(argv[2], "-w") == 0)
+    {
+        const char *endings[RESULT_COUNT] = { "hunters", "ghost", "bored" };
+        for (int i = 0; i < RESULT_COUNT; i++)
+        {
+            if (strcmp(argv[3], endings[i]) == 0)
+            {
+                winner = (GameResult)i;
+                listSeeds = C_TRUE;
+                valid = C_TRUE;
+            }
+        }
+    }
+    if (!valid)
+    {
+        printf("Usage: %s FILE [-w hunters|ghost|bored]\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        printf("Error: Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    ResultsFileType results;
+    results.size = info.st_size;
+    if (results.size < sizeof(ResultsTrailerType))
+    {
+        printf("Error: %s is not a results file\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+    results.data = mmap(NULL, results.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (results.data == MAP_FAILED)
+    {
+        printf("Error: Failed to map %s\n", argv[1]);
+        return 1;
+    }
+
+    results.trailer = (const ResultsTrailerType *)(results.data + results.size - sizeof(ResultsTrailerType));
+    size_t footerSize = results.trailer->numBlocks * sizeof(ResultsBlockType) + RESULT_COLUMNS * sizeof(int32_t);
+    if (results.trailer->magic != RESULTS_MAGIC || results.trailer->numColumns != RESULT_COLUMNS ||
+        results.trailer->indexOffset + footerSize + sizeof(ResultsTrailerType) != results.size)
+    {
+        printf("Error: %s is not a results file\n", argv[1]);
+        munmap((void *)results.data, results.size);
+        return 1;
+    }
+    results.blocks = (const ResultsBlockType *)(results.data + results.trailer->indexOffset);
+    results.widths = (const int32_t *)(results.blocks + results.trailer->numBlocks);
+
+    if (listSeeds)
+    {
+        printSeeds(&results, winner);
+    }
+    else
+    {
+        printSummary(&results);
+    }
+
+    munmap((void *)results.data, results.size);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "defs.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+Function: void readStats(const LiveStatsType *live, LiveStatsType *snapshot, size_t size)
+Purpose: Copies a consistent snapshot out of the segment, retrying while the simulator is in the middle of a publish.
+in: live - Pointer to the mapped LiveStatsType segment
+out: snapshot - Pointer to the buffer of size bytes receiving the copy
+in: size - Size of the segment
+return: none
+*/
+static void readStats(const LiveStatsType *live, LiveStatsType *snapshot, size_t size)
+{
+    unsigned int before, after;
+    do
+    {
+        before = __atomic_load_n(&live->sequence, __ATOMIC_ACQUIRE);
+        memcpy(snapshot, live, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&live->sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) != 0 || before != after);
+}
+
+/*
+Function: void printStats(LiveStatsType *snapshot)
+Purpose: Prints one sample of the live counters. Up to STATS_TOP_ROOMS rooms every room's share of the ghost's time
+         is printed, in bigger houses only the STATS_TOP_ROOMS rooms it spent the most time in and the rest together.
+in: snapshot - Pointer to the LiveStatsType snapshot to print, with its room tables
+return: none
+*/
+static void printStats(LiveStatsType *snapshot)
+{
+    printf("games %ld | hunters won %ld | ghost won %ld | ghost bored %ld | active hunters %d | evidence %ld | updates %ld (%.0f/s)\n",
+           snapshot->gamesCompleted, snapshot->wins[RESULT_HUNTERS_WIN], snapshot->wins[RESULT_GHOST_WINS],
+           snapshot->wins[RESULT_GHOST_BORED], snapshot->activeHunters, snapshot->evidenceCollected,
+           snapshot->updates, snapshot->updatesPerSec);
+
+    char (*roomNames)[MAX_STR] = STATS_ROOM_NAMES(snapshot);
+    long *roomDwell = STATS_ROOM_DWELL(snapshot);
+    long totalDwell = 0;
+    for (int i = 0; i < snapshot->numRooms; i++)
+    {
+        totalDwell += roomDwell[i];
+    }
+    if (snapshot->numRooms <= STATS_TOP_ROOMS)
+    {
+        for (int i = 0; i < snapshot->numRooms; i++)
+        {
+            printf("    %-20s %5.1f%%\n", roomNames[i], totalDwell > 0 ? 100.0 * roomDwell[i] / totalDwell : 0.0);
+        }
+    }
+    else
+    {
+        // picks the busiest room left each time, a room already printed is marked by negating its count
+        long shown = 0;
+        for (int printed = 0; printed < STATS_TOP_ROOMS; printed++)
+        {
+            int busiest = -1;
+            for (int i = 0; i < snapshot->numRooms; i++)
+            {
+                if (roomDwell[i] >= 0 && (busiest < 0 || roomDwell[i] > roomDwell[busiest]))
+                {
+                    busiest = i;
+                }
+            }
+            printf("    %-20s %5.1f%%\n", roomNames[busiest], totalDwell > 0 ? 100.0 * roomDwell[busiest] / totalDwell : 0.0);
+            shown += roomDwell[busiest];
+            roomDwell[busiest] = -1 - roomDwell[busiest];
+        }
+        char others[MAX_STR];
+        snprintf(others, sizeof(others), "%d other rooms", snapshot->numRooms - STATS_TOP_ROOMS);
+        printf("    %-20s %5.1f%%\n", others, totalDwell > 0 ? 100.0 * (totalDwell - shown) / totalDwell : 0.0);
+    }
+    if (snapshot->roomsPlayed > snapshot->maxRooms)
+    {
+        printf("    houses of up to %d rooms were played, the ghost's time in rooms past id %d isn't counted\n",
+               snapshot->roomsPlayed, snapshot->maxRooms - 1);
+    }
+}
+
+// samples the live counters of a running fp --stats, once a second or -n times
+int main(int argc, char *argv[])
+{
+    int samples = -1;
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+    {
+        samples = atoi(argv[2]);
+    }
+    else if (argc != 1)
+    {
+        printf("Usage: %s [-n samples]\n", argv[0]);
+        return 1;
+    }
+
+    // the segment is only ever mapped read only, so the simulator can't be slowed down by this reader
+    int fd = shm_open(STATS_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        printf("Error: No simulation is publishing to %s, start fp with --stats\n", STATS_SHM_NAME);
+        return 1;
+    }
+    // the size of the room tables is in the header, the file size says the segment is big enough to hold them
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(LiveStatsType))
+    {
+        printf("Error: %s isn't set up yet\n", STATS_SHM_NAME);
+        close(fd);
+        return 1;
+    }
+    size_t size = info.st_size;
+    const LiveStatsType *live = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (live == MAP_FAILED)
+    {
+        printf("Error: Failed to map %s\n", STATS_SHM_NAME);
+        return 1;
+    }
+    if (STATS_SEGMENT_SIZE(live->maxRooms) > size)
+    {
+        printf("Error: %s is too small for its %d rooms\n", STATS_SHM_NAME, live->maxRooms);
+        munmap((void *)live, size);
+        return 1;
+    }
+
+    LiveStatsType *snapshot = malloc(size);
+    if (snapshot == NULL)
+    {
+        printf("Error allocating memory for stats\n");
+        return 1;
+    }
+    for (int i = 0; samples < 0 || i < samples; i++)
+    {
+        readStats(live, snapshot, size);
+        printStats(snapshot);
+        sleep(1);
+    }
+
+    free(snapshot);
+    munmap((void *)live, size);
+    return 0;
+}
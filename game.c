@@ -0,0 +1,366 @@
+#include "defs.h"
+
+/*
+Function: void placeGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR], unsigned char *visited[])
+Purpose: Starts a game in a house whose rooms, occupancy and evidence index are ready: ties the evidence lists to the
+         index, places the ghost and the hunters and resets the shared state. Nothing is allocated.
+in/out: game - Pointer to the GameType structure, its ghost already allocated
+in: config - Pointer to the SimConfigType structure holding the simulation options
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: visited - Array of NUM_HUNTERS visited flag blocks, one per hunter, used with the frontier policy
+return: none
+*/
+static void placeGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR], unsigned char *visited[])
+{
+    HouseType *house = &game->house;
+    // track which rooms hold each type of evidence, and switch every room to a fading ring if asked
+    for (int i = 0; i < house->index->numRooms; i++) {
+        attachEvidenceIndex(house->index->rooms[i]->evidencelist, house->evidenceIndex, i);
+        if (config->fadeTime > 0) {
+            setEvidenceFadeTime(house->index->rooms[i]->evidencelist, config->fadeTime);
+        }
+    }
+
+    // Place the ghost in a random room, that is not the van
+    GhostType *ghost = game->ghost;
+    RoomType* randomRoom = getRandomRoomExcludeVan(house);  // You need to implement this function
+    initGhost(ghost, randomGhost(), randomRoom);
+
+    //creating initial room hunter should be in 
+    RoomType* vanRoom = house->rooms->rhead->room;  // Assuming the Van room is the head of the room list
+
+    // Create a hunter for each name and add them to the house and initialize 
+    for (int i = 0; i < NUM_HUNTERS; i++) {
+        HunterType hunter;
+        initHunter(&hunter, i, hunterNames[i], EV_UNKNOWN, vanRoom);
+        if (config->hunterPolicy == POLICY_FRONTIER) {
+            // every hunter starts having seen the Van
+            hunter.visited = visited[i];
+            memset(hunter.visited, 0, frontierSize(house->index->numRooms));
+            hunter.unvisited = house->index->numRooms;
+            visitRoom(&hunter, vanRoom->id);
+        }
+        addHunter(house->hunterArray, &hunter);
+        //every hunter starts in the van
+        addOccupant(vanRoom, &house->hunterArray->hunter[i]);
+
+    }
+
+    // Assign random equipment to each hunter
+    assignRandomEquipment(house->hunterArray, house->hunterArray->size);  // You need to implement this function
+    
+    for (int i = 0; i < NUM_HUNTERS; i++) {
+        LOG_IF(LOG_CAT_INIT, l_hunterInit(house->hunterArray->hunter[i].name, house->hunterArray->hunter[i].equipment));
+    }
+
+    // Initialize the shared game state
+    SharedGameState *gameState = &game->state;
+    gameState->gameOver = 0; // Game starts with not being over
+    gameState->clock = 0;
+    gameState->firstEvidence = -1;
+    gameState->seed = config->seed;
+    gameState->stats = config->stats;
+    gameState->hunterPolicy = config->hunterPolicy;
+}
+
+/*
+Function: void setupGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR])
+Purpose: Builds the house of a game and places the ghost and the hunters in it, ready for their first turn.
+in/out: game - Pointer to the GameType structure to be initialized, it must not move while the game is played
+in: config - Pointer to the SimConfigType structure holding the simulation options
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: none
+*/
+void setupGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR]) {
+    // Initialize the random number generator
+    // Populate the house with the provided rooms
+    HouseType *house = &game->house;
+    setAllocPhase(PHASE_SETUP);
+    seedRandom(config->seed);
+    if (config->numRooms > 0) {
+        // a generated house is laid out from the game's own seed
+        initHouse(house);
+        generateRooms(house, config->numRooms);
+    }
+    else if (config->house != NULL) {
+        cloneHouse(house, config->house, &config->placement, config->node);
+    }
+    else {
+        initHouse(house);
+        populateRooms(house);
+    }
+    // Count the hunters in each room and track which rooms hold each type of evidence
+    createOccupancy(house, NUM_HUNTERS);
+    house->evidenceIndex = createEvidenceIndex(house->index->numRooms);
+
+    //allocate memory for the ghost
+    game->ghost = malloc(sizeof(GhostType));
+    if (game->ghost == NULL) {
+        printf("Error allocating memory for ghost\n");
+        exit(1);
+    }
+
+    unsigned char *visited[NUM_HUNTERS] = {NULL};
+    for (int i = 0; config->hunterPolicy == POLICY_FRONTIER && i < NUM_HUNTERS; i++) {
+        // rounded out to whole cache lines so no two hunters' flags share one
+        visited[i] = aligned_alloc(CACHE_LINE, frontierSize(house->index->numRooms));
+        if (visited[i] == NULL) {
+            printf("Error allocating memory for visited rooms\n");
+            exit(1);
+        }
+    }
+    placeGame(game, config, hunterNames, visited);
+}
+
+/*
+Function: void resetGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR])
+Purpose: Sets up the next game in the memory of a finished one. The rooms are copied again from the template into the
+         house's own block and the ghost, occupancy, evidence index and visited flags are reused, so nothing is
+         allocated and a game can be started this way while others are being played.
+in/out: game - Pointer to the GameType structure of a game scored but not freed, set up from config->house
+in: config - Pointer to the SimConfigType structure holding the simulation options, with the same template and policy
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: none
+*/
+void resetGame(GameType *game, SimConfigType *config, char hunterNames[][MAX_STR]) {
+    HouseType *house = &game->house;
+    seedRandom(config->seed);
+    // the hunters' order in the array is kept, so the flags go back to the hunter they were made for
+    unsigned char *visited[NUM_HUNTERS];
+    for (int i = 0; i < NUM_HUNTERS; i++) {
+        visited[i] = house->hunterArray->hunter[i].visited;
+    }
+    recloneHouse(house, config->house);
+    resetOccupancy(house, NUM_HUNTERS);
+    clearEvidenceIndex(house->evidenceIndex);
+    placeGame(game, config, hunterNames, visited);
+}
+
+/*
+Function: GameResult runGame(SimConfigType *config, char hunterNames[][MAX_STR])
+Purpose: Builds the house, plays one full game with a ghost thread and one thread per hunter, then prints the results.
+in: config - Pointer to the SimConfigType structure holding the simulation options
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: Returns how the game ended
+*/
+GameResult runGame(SimConfigType *config, char hunterNames[][MAX_STR]) {
+    GameType game;
+    setupGame(&game, config, hunterNames);
+    GhostType *ghost = game.ghost;
+    if (config->stats != NULL) {
+        setStatsRooms(config->stats, &game.house);
+    }
+
+    // Create threads
+    pthread_t hunterThreads[NUM_HUNTERS];
+    pthread_t ghostThread;
+
+
+    // Initialize ghostContext fields...
+    GhostBehaviorContext *ghostContext = malloc(sizeof(GhostBehaviorContext));
+    if (ghostContext == NULL) {
+        printf("Failed to allocate memory for ghost context\n");
+        exit(1);
+    }
+    
+    // Initialize ghostContext fields
+    initGhostBehaviorContext(ghostContext, ghost, &game.house, game.house.hunterArray, &game.state);
+    ghostContext->pacer = config->pacers != NULL ? &config->pacers[GHOST_AGENT] : NULL;
+    HunterBehaviorContext *hunterContexts[NUM_HUNTERS];  // Array to store contexts
+
+    if (isReplaying()) {
+        // a replay runs the recorded turns in order on this thread
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            hunterContexts[i] = allocOnNode(&config->placement, sizeof(HunterBehaviorContext), config->node);
+            initHunterBehaviorContext(hunterContexts[i], i + 1, &game.house.hunterArray->hunter[i], ghost, &game.house, game.house.evidenceArray, &game.state);
+        }
+        setAllocPhase(PHASE_RUN);
+        replayGame(ghostContext, hunterContexts);
+        setAllocPhase(PHASE_TEARDOWN);
+    } else {
+        // Each hunter's context and visited flags are allocated on the node of the core it will run on
+        int hunterCores[NUM_HUNTERS];
+        size_t visitedSize = frontierSize(game.house.index->numRooms);
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            HunterType *hunter = &game.house.hunterArray->hunter[i];
+            hunterCores[i] = getWorkerCore(&config->placement, i + 1);
+            int hunterNode = getCoreNode(&config->placement, hunterCores[i]);
+            hunterContexts[i] = allocOnNode(&config->placement, sizeof(HunterBehaviorContext), hunterNode);
+            if (hunterContexts[i] == NULL) {
+                printf("Failed to allocate memory for hunter context\n");
+                exit(1);
+            }
+            if (placesMemory(&config->placement) && hunter->visited != NULL) {
+                hunter->visited = moveToNode(&config->placement, hunter->visited, visitedSize, hunterNode);
+                game.house.visitedMapped = C_TRUE;
+            }
+            // Initialize hunterContext fields
+            initHunterBehaviorContext(hunterContexts[i], i + 1, hunter, ghost, &game.house, game.house.evidenceArray, &game.state);
+            hunterContexts[i]->pacer = config->pacers != NULL ? &config->pacers[i + 1] : NULL;
+        }
+
+        // The ghost runs on the first core, the house it keeps touching was copied onto that core's node
+        int ghostCore = getWorkerCore(&config->placement, 0);
+        if (createPinnedThread(&config->placement, &ghostThread, ghostCore, ghostBehav, ghostContext) == 0) {
+            LOG_IF(LOG_CAT_INIT, l_placement("Ghost", ghostCore, getCoreNode(&config->placement, ghostCore)));
+        }
+
+        // Create one thread for each hunter, pinned before it takes its first turn
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            if (createPinnedThread(&config->placement, &hunterThreads[i], hunterCores[i], hunterBehav, hunterContexts[i]) == 0) {
+                LOG_IF(LOG_CAT_INIT, l_placement(game.house.hunterArray->hunter[i].name, hunterCores[i], getCoreNode(&config->placement, hunterCores[i])));
+            }
+        }
+
+        // Join threads and free their contexts
+        pthread_join(ghostThread, NULL);
+
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            // joining the thread
+            pthread_join(hunterThreads[i], NULL);
+        }
+        setAllocPhase(PHASE_TEARDOWN);
+        endGameRecord();
+    }
+
+    GameResult result = finishGame(&game, config);
+    free(ghostContext);
+    for (int i = 0; i < NUM_HUNTERS; i++) {
+        freeOnNode(hunterContexts[i], sizeof(HunterBehaviorContext));
+    }
+    return result;
+}
+
+/*
+Function: void freeGame(GameType *game)
+Purpose: Frees the house, hunters and ghost of a game, whether or not it was played out, without tallying it.
+in/out: game - Pointer to the GameType structure set up by setupGame
+return: none
+*/
+void freeGame(GameType *game) {
+    HouseType *house = &game->house;
+    size_t visitedSize = frontierSize(house->index->numRooms);
+    for (int i = 0; i < NUM_HUNTERS; i++) {
+        if (house->visitedMapped) {
+            freeOnNode(house->hunterArray->hunter[i].visited, visitedSize);
+        }
+        else {
+            free(house->hunterArray->hunter[i].visited);
+        }
+    }
+    freeGhost(game->ghost);
+    freeHouse(house);
+}
+
+/*
+Function: GameResult scoreGame(GameType *game, SimConfigType *config)
+Purpose: Prints the results of a game that has been played out and records them, leaving the house as it is.
+in: game - Pointer to the GameType structure of the finished game
+in: config - Pointer to the SimConfigType structure the game was set up with
+return: Returns how the game ended
+*/
+GameResult scoreGame(GameType *game, SimConfigType *config) {
+    HouseType *house = &game->house;
+    GhostType *ghost = game->ghost;
+    //temp variables to count the fear and boredom
+    int fear_count = 0;
+    int boredom_count_hunter = 0;
+    printf("\nAll done! Let's tally the results...\n");
+    printf("=================================\n");
+
+    //analyze each hunter fear 
+    if(house->hunterArray->size == 0){
+        printf("There are no hunters left in the house\n");
+        fear_count = NUM_HUNTERS;
+    }
+    else{
+        for(int i = 0; i < house->hunterArray->size; i++){
+            if(house->hunterArray->hunter[i].fear >= FEAR_MAX){
+                printf("%s has been scared out of the house\n", house->hunterArray->hunter[i].name);
+                fear_count++;
+            }
+        }
+
+    }
+
+    //analyze each hunter boredom
+    for(int i = 0; i < house->hunterArray->size; i++){
+        if(house->hunterArray->hunter[i].boredom >= BOREDOM_MAX){
+            printf("%s has gotten bored and left the house\n", house->hunterArray->hunter[i].name);
+            boredom_count_hunter++;
+        }
+    }
+
+    //print the evidence that has been collected
+    char ev[3][MAX_STR];
+    printf("The evidence collected is: \n");
+    for(int i = 0; i < house->evidenceArray->size; i++){
+        evidenceToString(house->evidenceArray->evidence[i], ev[i]);
+        printf("%s\n", ev[i]);
+    }
+
+    printf("\n"); 
+    // Check if the ghost has won
+    GameResult result;
+    if (fear_count  == NUM_HUNTERS || boredom_count_hunter == NUM_HUNTERS || house->hunterCount == 0) {
+        printf("The ghost has won the game!\n");
+        result = RESULT_GHOST_WINS;
+    } 
+    // Check if the hunters have won
+    else if(house->evidenceArray->size == 3) 
+    {
+        printf("The hunters have won the game!\n");
+        reviewEvidence(house->evidenceArray, ghost);
+        result = RESULT_HUNTERS_WIN;
+
+    }
+    else{
+        printf("The ghost's boredom level is %d\n", ghost->boredomTime);
+        printf("The ghost got bored and left\n");
+        result = RESULT_GHOST_BORED;
+    }
+
+    if (config->sketch != NULL) {
+        recordGameSketch(config->sketch, game);
+    }
+    if (config->results != NULL) {
+        ResultRecordType record;
+        memset(&record, 0, sizeof(record));
+        record.numRooms = house->index->numRooms;
+        record.hunterPolicy = config->hunterPolicy;
+        record.fadeTime = config->fadeTime;
+        record.seed = game->state.seed;
+        record.winner = result;
+        record.ghostClass = ghost->ghostType;
+        record.identified = identifyGhost(house->evidenceArray);
+        record.length = game->state.clock;
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            // hunters still in the house stayed until the end
+            HunterType *hunter = &house->hunterArray->hunter[i];
+            record.exitReason[i] = hunter->exitReason;
+            record.exitTime[i] = hunter->exitReason == LOG_UNKNOWN ? game->state.clock : hunter->exitTime;
+        }
+        for (int i = 0; i < house->evidenceArray->size; i++) {
+            record.evidence |= 1 << house->evidenceArray->evidence[i];
+        }
+        appendResult(config->results, &record);
+    }
+
+    if (config->stats != NULL) {
+        recordGame(config->stats, result);
+    }
+    return result;
+}
+
+/*
+Function: GameResult finishGame(GameType *game, SimConfigType *config)
+Purpose: Prints the results of a game that has been played out, records them and frees the house.
+in/out: game - Pointer to the GameType structure of the finished game, its house is freed
+in: config - Pointer to the SimConfigType structure the game was set up with
+return: Returns how the game ended
+*/
+GameResult finishGame(GameType *game, SimConfigType *config) {
+    GameResult result = scoreGame(game, config);
+    freeGame(game);
+    return result;
+}
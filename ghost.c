@@ -21,38 +21,80 @@ void initGhost(GhostType *ghost, enum GhostClass type, RoomType *room)
     ghost->ghostType = type;
     ghost->room = room;     // You can pass NULL if the ghost isn't in a room initially
     ghost->boredomTime = 0; // Initialize with some default value or a parameter
+    ghost->version = 0;
+    ghost->dropped = 0;
 
     // Call l_ghostInit with the ghost type and room name
-    l_ghostInit(ghost->ghostType, room != NULL ? room->name : "No Room");
+    LOG_IF(LOG_CAT_INIT, l_ghostInit(ghost->ghostType, room != NULL ? room->name : "No Room"));
 }
 
 /*
-Function: void updateGhostState(GhostType *ghost, HunterArrayType *hunters, SharedGameState *sharedState)
+Function: void publishGhost(GhostType *ghost, RoomType *room, int boredomTime)
+Purpose: Changes the ghost's room and boredom as one update that readGhost sees either all or none of.
+         Only the ghost's own thread may call it, so it never waits for anyone.
+in/out: ghost - Pointer to the GhostType structure to be changed
+in: room - Pointer to the RoomType structure the ghost is now in
+in: boredomTime - The ghost's new boredom
+return: none
+*/
+void publishGhost(GhostType *ghost, RoomType *room, int boredomTime)
+{
+    __atomic_store_n(&ghost->version, ghost->version + 1, __ATOMIC_RELAXED);
+    // a reader that sees any of the new fields also sees the odd version, so it tries again
+    __atomic_store_n(&ghost->room, room, __ATOMIC_RELEASE);
+    __atomic_store_n(&ghost->boredomTime, boredomTime, __ATOMIC_RELEASE);
+    __atomic_store_n(&ghost->version, ghost->version + 1, __ATOMIC_RELEASE);
+}
+
+/*
+Function: void readGhost(GhostType *ghost, GhostViewType *view)
+Purpose: Copies what other threads can see of the ghost without taking a lock. The copy is retried only if it
+         overlapped one of the ghost's updates, so it never holds the ghost up and is never half old and half new.
+in: ghost - Pointer to the GhostType structure to be read
+out: view - Pointer to the GhostViewType structure the copy is written to
+return: none
+*/
+void readGhost(GhostType *ghost, GhostViewType *view)
+{
+    unsigned int before;
+    unsigned int after;
+    do
+    {
+        before = __atomic_load_n(&ghost->version, __ATOMIC_ACQUIRE);
+        view->ghostType = __atomic_load_n(&ghost->ghostType, __ATOMIC_RELAXED);
+        // acquiring the fields keeps the version check from moving up past them
+        view->room = __atomic_load_n(&ghost->room, __ATOMIC_ACQUIRE);
+        view->boredomTime = __atomic_load_n(&ghost->boredomTime, __ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&ghost->version, __ATOMIC_RELAXED);
+    } while ((before & 1) != 0 || before != after);
+}
+
+/*
+Function: int updateGhostState(GhostType *ghost, SharedGameState *sharedState)
 Purpose: Updates the state of a ghost based on the presence of hunters and random actions.
 in/out: ghost - Pointer to the GhostType structure to be updated
-in: hunters - Pointer to the HunterArrayType structure representing the array of hunters
 in/out: sharedState - Pointer to the SharedGameState structure representing the shared game state
-return: none
+return: Returns C_TRUE if the ghost is still in the house, C_FALSE once it has left
 */
-void updateGhostState(GhostType *ghost, HunterArrayType *hunters, SharedGameState *sharedState)
+int updateGhostState(GhostType *ghost, SharedGameState *sharedState)
 {
     // Check if a hunter is in the same room as the ghost
-    int isHunterInRoom = isHunterPresent(ghost, hunters);
+    int isHunterInRoom = isHunterPresent(ghost);
 
     if (isHunterInRoom)
     {
-        ghost->boredomTime = 0;
+        publishGhost(ghost, ghost->room, 0);
     }
     else
     {
-        ghost->boredomTime++;
+        publishGhost(ghost, ghost->room, ghost->boredomTime + 1);
         if (ghost->boredomTime >= BOREDOM_MAX)
         {
 
-            l_ghostExit(LOG_BORED);
+            LOG_IF(LOG_CAT_EXIT, l_ghostExit(LOG_BORED));
             sharedState->gameOver = 1; // Set game over condition
             // terminate all threads
-            pthread_exit(NULL);
+            return C_FALSE;
         }
     }
 
@@ -70,18 +112,23 @@ void updateGhostState(GhostType *ghost, HunterArrayType *hunters, SharedGameStat
         {
             printf("room is null\n");
         }
-        EvidenceType ev = addEvidence(ghost);
-        l_ghostEvidence(ev, ghost->room->name);
+        EvidenceType ev = addEvidence(ghost, __atomic_load_n(&sharedState->clock, __ATOMIC_RELAXED));
+        if (ev != EV_UNKNOWN)
+        {
+            ghost->dropped |= 1 << ev;
+        }
+        LOG_IF(LOG_CAT_EVIDENCE, l_ghostEvidence(ev, ghost->room->name));
         break;
     case 2:
         // printf("moving\n");
         if (!isHunterInRoom)
         {
             moveToRandomRoomGhost(ghost);
-            l_ghostMove(ghost->room->name);
+            LOG_IF(LOG_CAT_GHOST_MOVE, l_ghostMove(ghost->room->name));
         }
         break;
     }
+    return C_TRUE;
 }
 
 /*
@@ -102,6 +149,37 @@ void initGhostBehaviorContext(GhostBehaviorContext *context, GhostType *ghost, H
     context->hunters = hunters;
     context->house = house;
     context->sharedState = sharedState;
+    context->pacer = NULL;
+}
+
+/*
+Function: int stepGhost(GhostBehaviorContext *context)
+Purpose: Runs one turn of the ghost's loop: checks it is still playing, updates it and checks if the game has ended.
+in/out: context - Pointer to a GhostBehaviorContext structure containing information about the ghost's behavior context - modified shared state
+return: Returns C_TRUE if the ghost keeps playing, C_FALSE once the game is over
+*/
+int stepGhost(GhostBehaviorContext *context)
+{
+    // While loop should run until the ghost is bored or the game is over
+    if (context->ghost->boredomTime >= BOREDOM_MAX || context->sharedState->gameOver != 0 || context->house->hunterCount <= 0)
+    {
+        return C_FALSE;
+    }
+
+    if (!updateGhostState(context->ghost, context->sharedState))
+    {
+        return C_FALSE;
+    }
+    __atomic_fetch_add(&context->sharedState->clock, 1, __ATOMIC_RELAXED);
+    countUpdate(context->sharedState->stats);
+    countGhostDwell(context->sharedState->stats, context->ghost->room);
+
+    if (context->ghost->boredomTime >= BOREDOM_MAX || context->house->hunterCount == 0)
+    {
+        context->sharedState->gameOver = 1; // Set game over condition
+        return C_FALSE;
+    }
+    return C_TRUE;
 }
 
 /*
@@ -119,20 +197,24 @@ void *ghostBehav(void *param)
         pthread_exit(NULL);
     }
 
-    
-    // While loop should run until the ghost is bored or the game is over
-    while (context->ghost->boredomTime < BOREDOM_MAX && context->sharedState->gameOver == 0 && context->house->hunterCount > 0)
+    // nothing in the game loop should need the heap
+    setAllocPhase(PHASE_RUN);
+    seedRandom(agentSeed(context->sharedState->seed, GHOST_AGENT));
+    startPacer(context->pacer);
+    while (C_TRUE)
     {
-        updateGhostState(context->ghost, context->hunters, context->sharedState);
-
-        if (context->ghost->boredomTime >= BOREDOM_MAX || context->house->hunterCount == 0)
+        // a recording makes each turn atomic so its order can be replayed
+        beginStep(GHOST_AGENT);
+        int playing = stepGhost(context);
+        endStep();
+        if (!playing)
         {
-            context->sharedState->gameOver = 1; // Set game over condition
-            break;                              // Exit the loop
+            break;
         }
 
-        usleep(GHOST_WAIT);
+        waitTurn(context->pacer, GHOST_WAIT);
     }
+    setAllocPhase(PHASE_TEARDOWN);
 
     pthread_exit(NULL);
 }
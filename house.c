@@ -1,4 +1,5 @@
 #include "defs.h"
+#include <stddef.h>
 
 /*
 Function: void populateRooms(HouseType* house)
@@ -56,6 +57,73 @@ void populateRooms(HouseType* house) {
     addRoom(house->rooms, living_room);
     addRoom(house->rooms, garage);
     addRoom(house->rooms, utility_room);
+
+    // Build the distances between rooms now the house won't change
+    buildRoomIndex(house);
+}
+
+/*
+Function: int areConnected(RoomType *room1, RoomType *room2)
+Purpose: Checks if two rooms are already connected.
+in: room1 - Pointer to the first RoomType structure
+in: room2 - Pointer to the second RoomType structure
+return: Returns C_TRUE if the rooms are connected, C_FALSE otherwise
+*/
+static int areConnected(RoomType *room1, RoomType *room2) {
+    if (room1->roomlist == NULL) {
+        return C_FALSE;
+    }
+    for (RoomNodeType *current = room1->roomlist->rhead; current != NULL; current = current->next) {
+        if (current->room == room2) {
+            return C_TRUE;
+        }
+    }
+    return C_FALSE;
+}
+
+/*
+Function: void generateRooms(HouseType* house, int numRooms)
+Purpose: Creates a random house with the Van and numRooms - 1 other rooms. Each room connects to one of the few
+         rooms created just before it, giving long corridors, and one room in ten gets an extra connection.
+in/out: house - Pointer to a HouseType structure to be populated with rooms
+in: numRooms - Number of rooms including the Van, at least 3
+return: none
+*/
+void generateRooms(HouseType* house, int numRooms) {
+    if (numRooms < 3) {
+        printf("Error: A generated house needs at least 3 rooms\n");
+        exit(1);
+    }
+
+    RoomType **rooms = malloc(numRooms * sizeof(RoomType *));
+    if (rooms == NULL) {
+        printf("Error allocating memory for generated rooms\n");
+        exit(1);
+    }
+
+    char name[MAX_STR];
+    rooms[0] = createRoom("Van");
+    addRoom(house->rooms, rooms[0]);
+    for (int i = 1; i < numRooms; i++) {
+        snprintf(name, MAX_STR, "Room %d", i);
+        rooms[i] = createRoom(name);
+        addRoom(house->rooms, rooms[i]);
+
+        int first = i > 4 ? i - 4 : 0;
+        connectRooms(rooms[i], rooms[randInt(first, i)]);
+    }
+
+    // A few loops so there is more than one way around the house
+    for (int i = 0; i < numRooms / 10; i++) {
+        RoomType *room1 = rooms[randInt(1, numRooms)];
+        RoomType *room2 = rooms[randInt(1, numRooms)];
+        if (room1 != room2 && !areConnected(room1, room2)) {
+            connectRooms(room1, room2);
+        }
+    }
+    free(rooms);
+
+    buildRoomIndex(house);
 }
 
 /*
@@ -96,6 +164,245 @@ void initHouse(HouseType *house) {
     initEvidenceArray(house->evidenceArray, MAX_EVIDENCE); // Set an appropriate initial capacity
 
     house->hunterCount = NUM_HUNTERS;
+    house->index = NULL;
+    house->evidenceIndex = NULL;
+    house->block = NULL;
+    house->blockMapped = 0;
+    house->visitedMapped = C_FALSE;
+    house->occupancy = NULL;
+    house->numShards = 0;
+    house->occupants = NULL;
+}
+
+// moves a pointer into a template's image to the same place in a copy of the image
+#define RELOCATE(pointer, delta) do { if ((pointer) != NULL) { (pointer) = (void *)((char *)(pointer) + (delta)); } } while (0)
+
+/*
+Function: size_t reserveImage(size_t *size, size_t bytes)
+Purpose: Reserves the next part of a template's image, keeping every part aligned for any type.
+in/out: size - The size of the image so far, grown by the part
+in: bytes - Size of the part
+return: Returns the offset of the part in the image
+*/
+static size_t reserveImage(size_t *size, size_t bytes) {
+    size_t offset = (*size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    *size = offset + bytes;
+    return offset;
+}
+
+/*
+Function: HouseTemplateType *createHouseTemplate(int numRooms)
+Purpose: Builds a house once and lays its rooms, their connections and their empty evidence lists out in
+         one image, so a game's house is a single copy of it. The distances between rooms are kept for every game to share.
+in: numRooms - Rooms of a generated house, laid out from the calling thread's random numbers, 0 for the default house
+return: Returns a pointer to the new HouseTemplateType structure
+*/
+HouseTemplateType *createHouseTemplate(int numRooms) {
+    HouseType house;
+    initHouse(&house);
+    if (numRooms > 0) {
+        generateRooms(&house, numRooms);
+    }
+    else {
+        populateRooms(&house);
+    }
+
+    HouseTemplateType *houseTemplate = malloc(sizeof(HouseTemplateType));
+    if (houseTemplate == NULL) {
+        printf("Error allocating memory for house template\n");
+        exit(1);
+    }
+    numRooms = house.index->numRooms;
+    int numNodes = numRooms;
+    for (int i = 0; i < numRooms; i++) {
+        numNodes += house.index->rooms[i]->roomlist != NULL ? house.index->rooms[i]->roomlist->size : 0;
+    }
+    houseTemplate->numRooms = numRooms;
+    houseTemplate->numNodes = numNodes;
+
+    size_t size = 0;
+    houseTemplate->listOffset = reserveImage(&size, sizeof(RoomListType));
+    houseTemplate->roomsOffset = reserveImage(&size, numRooms * sizeof(RoomType));
+    houseTemplate->roomListsOffset = reserveImage(&size, numRooms * sizeof(RoomListType));
+    houseTemplate->nodesOffset = reserveImage(&size, numNodes * sizeof(RoomNodeType));
+    houseTemplate->evidenceOffset = reserveImage(&size, numRooms * sizeof(EvidenceListType));
+    houseTemplate->indexOffset = reserveImage(&size, sizeof(RoomIndexType) + numRooms * sizeof(RoomType *));
+    houseTemplate->size = (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    houseTemplate->image = aligned_alloc(CACHE_LINE, houseTemplate->size);
+    if (houseTemplate->image == NULL) {
+        printf("Error allocating memory for house template\n");
+        exit(1);
+    }
+    memset(houseTemplate->image, 0, houseTemplate->size);
+
+    char *image = houseTemplate->image;
+    RoomListType *list = (RoomListType *)(image + houseTemplate->listOffset);
+    RoomType *rooms = (RoomType *)(image + houseTemplate->roomsOffset);
+    RoomListType *roomLists = (RoomListType *)(image + houseTemplate->roomListsOffset);
+    RoomNodeType *nodes = (RoomNodeType *)(image + houseTemplate->nodesOffset);
+    EvidenceListType *evidenceLists = (EvidenceListType *)(image + houseTemplate->evidenceOffset);
+    RoomIndexType *index = (RoomIndexType *)(image + houseTemplate->indexOffset);
+    RoomType **indexRooms = (RoomType **)(index + 1);
+
+    // the house's own list takes the first numRooms nodes, in id order so the Van stays at its head
+    int nextNode = 0;
+    list->size = numRooms;
+    for (int i = 0; i < numRooms; i++) {
+        RoomType *built = house.index->rooms[i];
+        rooms[i] = *built;
+        rooms[i].ghost = NULL;
+        rooms[i].evidencelist = &evidenceLists[i];
+        initEvidenceList(&evidenceLists[i]);
+        indexRooms[i] = &rooms[i];
+
+        RoomNodeType *node = &nodes[nextNode++];
+        node->room = &rooms[i];
+        node->next = NULL;
+        if (list->rtail != NULL) {
+            list->rtail->next = node;
+        }
+        else {
+            list->rhead = node;
+        }
+        list->rtail = node;
+    }
+
+    // connections keep the order they were made in, so moves draw the same rooms as in a built house
+    for (int i = 0; i < numRooms; i++) {
+        RoomType *built = house.index->rooms[i];
+        rooms[i].roomlist = NULL;
+        if (built->roomlist == NULL) {
+            continue;
+        }
+        rooms[i].roomlist = &roomLists[i];
+        for (RoomNodeType *connected = built->roomlist->rhead; connected != NULL; connected = connected->next) {
+            RoomNodeType *node = &nodes[nextNode++];
+            node->room = &rooms[connected->room->id];
+            node->next = NULL;
+            if (roomLists[i].rtail != NULL) {
+                roomLists[i].rtail->next = node;
+            }
+            else {
+                roomLists[i].rhead = node;
+            }
+            roomLists[i].rtail = node;
+            roomLists[i].size++;
+        }
+    }
+
+    // the distances move over to the template, each copy gets its own list of its rooms
+    houseTemplate->index = house.index;
+    *index = *house.index;
+    index->rooms = indexRooms;
+    house.index = NULL;
+    freeHouse(&house);
+    free(houseTemplate->index->rooms);
+    houseTemplate->index->rooms = NULL;
+    return houseTemplate;
+}
+
+/*
+Function: void copyHouseImage(HouseType *house, HouseTemplateType *houseTemplate, char *block)
+Purpose: Copies a template's image into a block and points the copy at itself, making the block the house's rooms.
+in/out: house - Pointer to the HouseType structure whose rooms are set to the copy
+in: houseTemplate - Pointer to the HouseTemplateType structure to copy
+in/out: block - Block of the template's size the image is copied into
+return: none
+*/
+static void copyHouseImage(HouseType *house, HouseTemplateType *houseTemplate, char *block) {
+    memcpy(block, houseTemplate->image, houseTemplate->size);
+    ptrdiff_t delta = block - houseTemplate->image;
+
+    RoomListType *list = (RoomListType *)(block + houseTemplate->listOffset);
+    RoomType *rooms = (RoomType *)(block + houseTemplate->roomsOffset);
+    RoomListType *roomLists = (RoomListType *)(block + houseTemplate->roomListsOffset);
+    RoomNodeType *nodes = (RoomNodeType *)(block + houseTemplate->nodesOffset);
+    EvidenceListType *evidenceLists = (EvidenceListType *)(block + houseTemplate->evidenceOffset);
+    RoomIndexType *index = (RoomIndexType *)(block + houseTemplate->indexOffset);
+
+    RELOCATE(list->rhead, delta);
+    RELOCATE(list->rtail, delta);
+    sem_init(&list->sem, 0, 1);
+    for (int i = 0; i < houseTemplate->numNodes; i++) {
+        RELOCATE(nodes[i].room, delta);
+        RELOCATE(nodes[i].next, delta);
+    }
+    for (int i = 0; i < houseTemplate->numRooms; i++) {
+        RELOCATE(rooms[i].roomlist, delta);
+        RELOCATE(rooms[i].evidencelist, delta);
+        RELOCATE(roomLists[i].rhead, delta);
+        RELOCATE(roomLists[i].rtail, delta);
+        // a copied semaphore isn't a semaphore, each one is set up again
+        sem_init(&roomLists[i].sem, 0, 1);
+        sem_init(&evidenceLists[i].sem, 0, 1);
+    }
+    RELOCATE(index->rooms, delta);
+    for (int i = 0; i < houseTemplate->numRooms; i++) {
+        RELOCATE(index->rooms[i], delta);
+    }
+
+    house->rooms = list;
+    house->index = index;
+}
+
+/*
+Function: void cloneHouse(HouseType *house, HouseTemplateType *houseTemplate, PlacementType *placement, int node)
+Purpose: Sets up a house for a new game by copying the template's image and pointing the copy at itself. When
+         memory is placed on NUMA nodes the copy is put on the given node.
+in/out: house - Pointer to the HouseType structure to be initialized
+in: houseTemplate - Pointer to the HouseTemplateType structure to copy
+in: placement - Pointer to the PlacementType structure describing the machine
+in: node - The node the rooms should live on
+return: none
+*/
+void cloneHouse(HouseType *house, HouseTemplateType *houseTemplate, PlacementType *placement, int node) {
+    initHouse(house);
+    free(house->rooms);
+
+    char *block;
+    if (placesMemory(placement)) {
+        block = allocOnNode(placement, houseTemplate->size, node);
+        house->blockMapped = houseTemplate->size;
+    }
+    else {
+        block = aligned_alloc(CACHE_LINE, houseTemplate->size);
+        if (block == NULL) {
+            printf("Error allocating memory for house\n");
+            exit(1);
+        }
+    }
+    copyHouseImage(house, houseTemplate, block);
+    house->block = block;
+}
+
+/*
+Function: void recloneHouse(HouseType *house, HouseTemplateType *houseTemplate)
+Purpose: Puts a house cloned from a template back the way the template has it for another game, copying the image
+         again into the block it already has. The hunter and evidence arrays are emptied, nothing is allocated.
+in/out: house - Pointer to the HouseType structure, cloned from the same template and not freed
+in: houseTemplate - Pointer to the HouseTemplateType structure it was cloned from
+return: none
+*/
+void recloneHouse(HouseType *house, HouseTemplateType *houseTemplate) {
+    copyHouseImage(house, houseTemplate, house->block);
+    house->hunterArray->size = 0;
+    house->evidenceArray->size = 0;
+    house->hunterCount = NUM_HUNTERS;
+}
+
+/*
+Function: void freeHouseTemplate(HouseTemplateType *houseTemplate)
+Purpose: Frees a house template, no house copied from it may still be in use.
+in/out: houseTemplate - Pointer to the HouseTemplateType structure to be freed
+return: none
+*/
+void freeHouseTemplate(HouseTemplateType *houseTemplate) {
+    if (houseTemplate == NULL) {
+        return;
+    }
+    freeRoomIndex(houseTemplate->index);
+    free(houseTemplate->image);
+    free(houseTemplate);
 }
 
 /*
@@ -109,19 +416,35 @@ void freeHouse(HouseType *house) {
         return;
     }
 
-    //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
-    // co pilot was used to write this code
-    RoomNodeType *current = house->rooms->rhead;
-    if(current == NULL) {
-        return;
+    if (house->block != NULL) {
+        // rooms copied from a template live in one block, and share the template's distances
+        if (house->blockMapped > 0) {
+            freeOnNode(house->block, house->blockMapped);
+        }
+        else {
+            free(house->block);
+        }
+        freeEvidenceIndex(house->evidenceIndex);
+        freeOccupancy(house);
     }
-    while (current != NULL) {
-        RoomNodeType *temp = current;
-        current = current->next;
-        freeRoom(temp->room); // Free the room
-        free(temp); // Free the node
+    else {
+        //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
+        // co pilot was used to write this code
+        RoomNodeType *current = house->rooms->rhead;
+        if(current == NULL) {
+            return;
+        }
+        while (current != NULL) {
+            RoomNodeType *temp = current;
+            current = current->next;
+            freeRoom(temp->room); // Free the room
+            free(temp); // Free the node
+        }
+        free(house->rooms); 
+        freeRoomIndex(house->index);
+        freeEvidenceIndex(house->evidenceIndex);
+        freeOccupancy(house);
     }
-    free(house->rooms); 
 
     // Free the hunter array
     clearHunterArray(house->hunterArray); // Assuming this function exists and frees the array correctly
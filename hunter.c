@@ -1,14 +1,15 @@
 #include "defs.h"
 
 /*
-Function: void initHunter(HunterType *hunter, const char *name, EvidenceType equipment, RoomType *room)
+Function: void initHunter(HunterType *hunter, int id, const char *name, EvidenceType equipment, RoomType *room)
 Purpose: Initializes a HunterType structure with the provided values.
 in/out: hunter - Pointer to a HunterType structure to be initialized
+in: id - Index of the hunter in the house's hunter array
 in: name - Pointer to a string representing the hunter's name
 in: equipment - EvidenceType representing the hunter's equipment
 in: room - Pointer to a RoomType structure representing the initial room of the hunter
 */
-void initHunter(HunterType *hunter, const char *name, EvidenceType equipment, RoomType *room)
+void initHunter(HunterType *hunter, int id, const char *name, EvidenceType equipment, RoomType *room)
 {
     if (hunter == NULL)
     {
@@ -17,11 +18,18 @@ void initHunter(HunterType *hunter, const char *name, EvidenceType equipment, Ro
 
     //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
     // co pilot was used to write this code
+    hunter->id = id;               // Hunters are told apart by id, the name is only for output
+    hunter->slot = -1;             // Not in a room yet
     strcpy(hunter->name, name);    // Copy the name into the hunter's name field
     hunter->equipment = equipment; // Set the equipment
     hunter->fear = 0;              // Initialize fear to a default value
     hunter->boredom = 0;           // Initialize boredom to a default value
     hunter->room = room;           // Set the current room of the hunter
+    hunter->visited = NULL;        // Only allocated for the frontier policy
+    hunter->unvisited = 0;
+    hunter->searchMark = 0;
+    hunter->exitReason = LOG_UNKNOWN; // Still in the house
+    hunter->exitTime = -1;
 }
 
 /*
@@ -37,8 +45,8 @@ void initHunterArray(HunterArrayType *hunterArray, int initial_capacity)
         return; // Ensure the passed pointer is valid
     }
 
-    // Allocate memory for the array of HunterType
-    hunterArray->hunter = malloc(sizeof(HunterType) * initial_capacity);
+    // Allocate memory for the array of HunterType, aligned so each hunter's hot state has its own cache line
+    hunterArray->hunter = aligned_alloc(CACHE_LINE, sizeof(HunterType) * initial_capacity);
     if (hunterArray->hunter == NULL)
     {
         // Handle memory allocation failure
@@ -54,27 +62,30 @@ void initHunterArray(HunterArrayType *hunterArray, int initial_capacity)
 }
 
 /*
-Function: void initHunterBehaviorContext(HunterBehaviorContext *context, HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+Function: void initHunterBehaviorContext(HunterBehaviorContext *context, int id, HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
 Purpose: Initializes a HunterBehaviorContext structure with the provided references.
 in/out: context - Pointer to a HunterBehaviorContext structure to be initialized
+in: id - Agent id of the hunter in recordings, 1 for the first hunter
 in: hunter - Pointer to a HunterType structure representing the hunter
 in: ghosts - Pointer to a GhostType structure representing the ghosts in the house
 in: house - Pointer to a HouseType structure representing the house environment
 in: sharedEvidence - Pointer to an EvidenceArrayType structure for shared evidence collection
 in: sharedState - Pointer to a SharedGameState structure for shared game state
 */
-void initHunterBehaviorContext(HunterBehaviorContext *context, HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+void initHunterBehaviorContext(HunterBehaviorContext *context, int id, HunterType *hunter, GhostType *ghosts, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
 {
     if (context == NULL)
     {
         return; // Ensure the passed pointer is valid
     }
 
+    context->id = id;
     context->hunter = hunter;
     context->ghosts = ghosts;
     context->house = house;
     context->sharedEvidence = sharedEvidence;
     context->sharedState = sharedState;
+    context->pacer = NULL;
 }
 
 /*
@@ -110,6 +121,53 @@ int addHunter(HunterArrayType *hunterArray, const HunterType *newHunter)
 }
 
 
+/*
+Function: int stepHunter(HunterBehaviorContext *context)
+Purpose: Runs one turn of a hunter's loop: checks it is still playing, updates it and checks if the game has ended.
+in/out: context - Pointer to a HunterBehaviorContext structure representing the context for hunter behavior - modified shared state
+return: Returns C_TRUE if the hunter keeps playing, C_FALSE once it has left or the game is over
+*/
+int stepHunter(HunterBehaviorContext *context)
+{
+    //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
+    // co pilot was used to write this code
+    HunterType *hunter = context->hunter;
+    HouseType *house = context->house;
+    SharedGameState *sharedState = context->sharedState;
+
+    // Loop until the hunter is too fearful, bored, or enough evidence is collected
+    if (hunter->fear >= FEAR_MAX || hunter->boredom >= BOREDOM_MAX || sharedState->gameOver != 0)
+    {
+        return C_FALSE;
+    }
+
+    if (sharedState->hunterPolicy == POLICY_PARTY)
+    {
+        // the first hunter takes the party's turns, the others only go where it takes them
+        if (hunter->id != 0)
+        {
+            return C_TRUE;
+        }
+        if (!updatePartyState(hunter, context->ghosts, house, context->sharedEvidence, sharedState))
+        {
+            return C_FALSE;
+        }
+    }
+    else if (!updateHunterState(hunter, context->ghosts, house, context->sharedEvidence, sharedState))
+    {
+        return C_FALSE;
+    }
+    countUpdate(sharedState->stats);
+
+    // Check for game ending conditions
+    if (house->hunterCount == 0)
+    {
+        sharedState->gameOver = 1; // Set game over condition
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
 /*
 Function: void *hunterBehav(void *param)
 Purpose: Represents the behavior of a hunter in a separate thread, updating its state in the house environment.
@@ -126,48 +184,42 @@ void *hunterBehav(void *param)
         pthread_exit(NULL);
     }
 
-    //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
-    // co pilot was used to write this code
-    HunterType *hunter = context->hunter;
-    GhostType *ghosts = context->ghosts;
-    HouseType *house = context->house;
-    EvidenceArrayType *sharedEvidence = context->sharedEvidence;
-    SharedGameState *sharedState = context->sharedState;
-
-    // Loop until the hunter is too fearful, bored, or enough evidence is collected
-    while (hunter->fear < FEAR_MAX && hunter->boredom < BOREDOM_MAX && sharedState->gameOver == 0)
+    // nothing in the game loop should need the heap
+    setAllocPhase(PHASE_RUN);
+    seedRandom(agentSeed(context->sharedState->seed, context->id));
+    countActiveHunters(context->sharedState->stats, 1);
+    startPacer(context->pacer);
+    while (C_TRUE)
     {
-        updateHunterState(hunter, ghosts, house, sharedEvidence, sharedState);
-
-        // Check for game ending conditions
-        if (house->hunterCount == 0)
+        // a recording makes each turn atomic so its order can be replayed
+        beginStep(context->id);
+        int playing = stepHunter(context);
+        endStep();
+        if (!playing)
         {
-            sharedState->gameOver = 1; // Set game over condition
-            break;                     // Exit the loop
+            break;
         }
 
-        usleep(HUNTER_WAIT); // Wait for a predefined period before updating state again
+        waitTurn(context->pacer, HUNTER_WAIT); // Wait for a predefined period before updating state again
     }
+    countActiveHunters(context->sharedState->stats, -1);
+    setAllocPhase(PHASE_TEARDOWN);
 
     pthread_exit(NULL);
 }
 
 /*
-Function: void updateHunterState(HunterType *hunter, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
-Purpose: Updates the state of a hunter based on the current conditions in the house.
-in/out: hunter - Pointer to a HunterType structure representing the hunter to be updated
+Function: int checkHunterExit(HunterType *hunter, GhostType *ghost, HouseType *house, SharedGameState *sharedState)
+Purpose: Updates a hunter's fear and boredom for whether the ghost is in its room, and takes it out of the house once
+         either is too high.
+in/out: hunter - Pointer to a HunterType structure representing the hunter to be checked
 in: ghost - Pointer to a GhostType structure representing the ghost in the house
-in: house - Pointer to a HouseType structure representing the house environment
-in: sharedEvidence - Pointer to an EvidenceArrayType structure for shared evidence collection
-in/out: sharedState - Pointer to a SharedGameState structure for shared game state
+in/out: house - Pointer to a HouseType structure representing the house environment
+in: sharedState - Pointer to a SharedGameState structure for shared game state
+return: Returns C_TRUE if the hunter is still in the house, C_FALSE if it has left
 */
-void updateHunterState(HunterType *hunter, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+static int checkHunterExit(HunterType *hunter, GhostType *ghost, HouseType *house, SharedGameState *sharedState)
 {
-    if (hunter == NULL || house == NULL || sharedEvidence == NULL)
-    {
-        return; // Ensure the passed pointer is valid
-    }
-
     // Check if a ghost is in the same room as the hunter
     int isGhostInRoom = isGhostPresent(ghost, hunter);
 
@@ -183,63 +235,210 @@ void updateHunterState(HunterType *hunter, GhostType *ghost, HouseType *house, E
     if (hunter->fear >= FEAR_MAX)
     {
         // remove hunter from the array
-        l_hunterExit(hunter->name, LOG_FEAR);
-        // removeHunter(house->hunterArray, hunter);
+        LOG_IF(LOG_CAT_EXIT, l_hunterExit(hunter->name, LOG_FEAR));
+        hunter->exitReason = LOG_FEAR;
+        hunter->exitTime = __atomic_load_n(&sharedState->clock, __ATOMIC_RELAXED);
+        removeOccupant(hunter, house->hunterArray->hunter);
         house->hunterCount = house->hunterCount - 1;
-        pthread_exit(NULL);
+        return C_FALSE;
     }
     if (hunter->boredom >= BOREDOM_MAX)
     {
         // remove hunter from the array
-        l_hunterExit(hunter->name, LOG_BORED);
-        // removeHunter(house->hunterArray, hunter);
+        LOG_IF(LOG_CAT_EXIT, l_hunterExit(hunter->name, LOG_BORED));
+        hunter->exitReason = LOG_BORED;
+        hunter->exitTime = __atomic_load_n(&sharedState->clock, __ATOMIC_RELAXED);
+        removeOccupant(hunter, house->hunterArray->hunter);
         house->hunterCount = house->hunterCount - 1;
-        pthread_exit(NULL);
+        return C_FALSE;
+    }
+    return C_TRUE;
+}
+
+/*
+Function: void searchRoomHunter(HunterType *hunter, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+Purpose: Has a hunter search its room with its equipment, collecting the evidence it finds.
+in/out: hunter - Pointer to a HunterType structure representing the hunter searching
+in/out: sharedEvidence - Pointer to an EvidenceArrayType structure for shared evidence collection
+in/out: sharedState - Pointer to a SharedGameState structure for shared game state
+return: none
+*/
+static void searchRoomHunter(HunterType *hunter, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+{
+    // check if evidence is in the room of the hunter
+    long now = __atomic_load_n(&sharedState->clock, __ATOMIC_RELAXED);
+    if (sharedState->hunterPolicy == POLICY_FRONTIER)
+    {
+        // the frontier policy counts a room as visited once it has been searched
+        visitRoom(hunter, hunter->room->id);
+    }
+    EvidenceType collectedEv = isEvidencePresent(hunter->room, hunter->equipment, now);
+    if (collectedEv != EV_UNKNOWN)
+    {
+        // picking evidence up uses it up when rooms are fading
+        takeEvidence(hunter->room, collectedEv, now);
+        int added = collectEvidence(sharedEvidence, collectedEv);
+        if (added == 0)
+        {
+            // the evidence array is full or that type of evidence is already collected
+            LOG_IF(LOG_CAT_EVIDENCE, l_hunterCollectFailed(hunter->name));
+        }
+        else
+        {
+            LOG_IF(LOG_CAT_EVIDENCE, l_hunterCollect(hunter->name, collectedEv, hunter->room->name));
+            // only the first hunter to collect anything gets to set it
+            long unset = -1;
+            __atomic_compare_exchange_n(&sharedState->firstEvidence, &unset, now, C_FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            countEvidence(sharedState->stats);
+        }
+    }
+}
+
+/*
+Function: int reviewHunter(HunterType *hunter, GhostType *ghost, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+Purpose: Has a hunter review the shared evidence, ending the game if it is enough to name the ghost.
+in/out: hunter - Pointer to a HunterType structure representing the hunter reviewing
+in: ghost - Pointer to a GhostType structure representing the ghost in the house
+in: sharedEvidence - Pointer to an EvidenceArrayType structure for shared evidence collection
+in/out: sharedState - Pointer to a SharedGameState structure for shared game state
+return: Returns C_TRUE if the game goes on, C_FALSE if the hunters have won
+*/
+static int reviewHunter(HunterType *hunter, GhostType *ghost, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+{
+    if (reviewEvidence(sharedEvidence, ghost) == 1)
+    {
+        LOG_IF(LOG_CAT_REVIEW, l_hunterReview(hunter->name, LOG_SUFFICIENT));
+        hunter->exitReason = LOG_EVIDENCE;
+        hunter->exitTime = __atomic_load_n(&sharedState->clock, __ATOMIC_RELAXED);
+        // EXIT ALL THE THREADS FOR THE HUNTER
+        sharedState->gameOver = 1;
+        return C_FALSE;
+    }
+    LOG_IF(LOG_CAT_REVIEW, l_hunterReview(hunter->name, LOG_INSUFFICIENT));
+    return C_TRUE;
+}
+
+/*
+Function: int updateHunterState(HunterType *hunter, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+Purpose: Updates the state of a hunter based on the current conditions in the house.
+in/out: hunter - Pointer to a HunterType structure representing the hunter to be updated
+in: ghost - Pointer to a GhostType structure representing the ghost in the house
+in: house - Pointer to a HouseType structure representing the house environment
+in: sharedEvidence - Pointer to an EvidenceArrayType structure for shared evidence collection
+in/out: sharedState - Pointer to a SharedGameState structure for shared game state
+return: Returns C_TRUE if the hunter is still in the house, C_FALSE if it has left or the game is over
+*/
+int updateHunterState(HunterType *hunter, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+{
+    if (hunter == NULL || house == NULL || sharedEvidence == NULL)
+    {
+        return C_FALSE; // Ensure the passed pointer is valid
+    }
+
+    if (!checkHunterExit(hunter, ghost, house, sharedState))
+    {
+        return C_FALSE;
     }
     if (house->hunterArray->size == 0)
     {
         sharedState->gameOver = 1;
-        pthread_exit(NULL);
+        return C_FALSE;
     }
 
     switch (randInt(0, 3))
     {
-    case 0: // Move to a random, connected room
-        moveToRandomRoomHunter(hunter, house);
-        l_hunterMove(hunter->name, hunter->room->name);
+    case 0: // Move to a connected room
+        if (sharedState->hunterPolicy == POLICY_FRONTIER)
+        {
+            moveToFrontierRoomHunter(hunter, house);
+        }
+        else if (sharedState->hunterPolicy == POLICY_TRACKER)
+        {
+            moveToEvidenceRoomHunter(hunter, house, __atomic_load_n(&sharedState->clock, __ATOMIC_RELAXED));
+        }
+        else
+        {
+            moveToRandomRoomHunter(hunter, house);
+        }
+        LOG_IF(LOG_CAT_HUNTER_MOVE, l_hunterMove(hunter->name, hunter->room->name));
         break;
     case 1:
-        // check if evidence is in the room of the hunter
-        EvidenceType collectedEv = isEvidencePresent(hunter->room, hunter->equipment);
-        if (collectedEv != EV_UNKNOWN)
+        searchRoomHunter(hunter, sharedEvidence, sharedState);
+        break;
+
+    case 2: // Review evidence
+        return reviewHunter(hunter, ghost, sharedEvidence, sharedState);
+    }
+    return C_TRUE;
+}
+
+/*
+Function: int updatePartyState(HunterType *leader, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+Purpose: Takes the turn of a party policy game, where the hunters search the house together. Every hunter's fear and
+         boredom is updated as in updateHunterState, then the party does one thing: all of them move to the same
+         random connected room, each searches the room with its own equipment, or the leader reviews the evidence.
+         The other hunters' own turns do nothing, so the party is only safe to play where one thread takes all of
+         a game's turns.
+in/out: leader - Pointer to a HunterType structure representing the hunter whose turn it is, the first in the array
+in: ghost - Pointer to a GhostType structure representing the ghost in the house
+in/out: house - Pointer to a HouseType structure representing the house environment
+in/out: sharedEvidence - Pointer to an EvidenceArrayType structure for shared evidence collection
+in/out: sharedState - Pointer to a SharedGameState structure for shared game state
+return: Returns C_TRUE if the party is still in the house, C_FALSE if it has left or the game is over
+*/
+int updatePartyState(HunterType *leader, GhostType *ghost, HouseType *house, EvidenceArrayType *sharedEvidence, SharedGameState *sharedState)
+{
+    if (leader == NULL || house == NULL || sharedEvidence == NULL)
+    {
+        return C_FALSE; // Ensure the passed pointer is valid
+    }
+
+    // the hunters are always in the same room, so they are all scared or bored on the same turn
+    HunterType *party = house->hunterArray->hunter;
+    int size = house->hunterArray->size;
+    for (int i = 0; i < size; i++)
+    {
+        if (party[i].slot >= 0)
+        {
+            checkHunterExit(&party[i], ghost, house, sharedState);
+        }
+    }
+    if (house->hunterCount == 0)
+    {
+        return C_FALSE;
+    }
+
+    switch (randInt(0, 3))
+    {
+    case 0: // Move the party to a connected room
+        moveToRandomRoomHunter(leader, house);
+        for (int i = 0; i < size; i++)
         {
-            int added = collectEvidence(sharedEvidence, collectedEv);
-            if (added == 0)
+            if (party[i].slot < 0)
             {
-                printf("Failed to add evidence to shared array\n"); // if evidence array is full or that type of evidence is already collected
+                continue;
             }
-            else
+            if (&party[i] != leader)
             {
-                l_hunterCollect(hunter->name, collectedEv, hunter->room->name);
+                moveOccupant(&party[i], leader->room, party);
             }
+            LOG_IF(LOG_CAT_HUNTER_MOVE, l_hunterMove(party[i].name, party[i].room->name));
         }
         break;
-
-    case 2: // Review evidence
-
-        if (reviewEvidence(sharedEvidence, ghost) == 1)
-        {
-            l_hunterReview(hunter->name, LOG_SUFFICIENT);
-            // EXIT ALL THE THREADS FOR THE HUNTER
-            sharedState->gameOver = 1;
-            pthread_exit(NULL);
-        }
-        else
+    case 1:
+        for (int i = 0; i < size; i++)
         {
-            l_hunterReview(hunter->name, LOG_INSUFFICIENT);
+            if (party[i].slot >= 0)
+            {
+                searchRoomHunter(&party[i], sharedEvidence, sharedState);
+            }
         }
         break;
+
+    case 2: // Review evidence
+        return reviewHunter(leader, ghost, sharedEvidence, sharedState);
     }
+    return C_TRUE;
 }
 
 /*
@@ -269,7 +468,7 @@ void assignRandomEquipment(HunterArrayType *hunters, int numHunters)
         int isUnique = 0;
         do
         {
-            equipmentIndex = randInt(0, EV_COUNT - 1);
+            equipmentIndex = randInt(0, EV_COUNT);
             isUnique = 1;
 
             // Check if this equipment has already been assigned
@@ -287,36 +486,6 @@ void assignRandomEquipment(HunterArrayType *hunters, int numHunters)
     }
 }
 
-/*
-Function: void removeHunter(HunterArrayType *hunters_list, HunterType *hunter)
-Purpose: Removes a specified hunter from the list of hunters.
-in/out: hunters_list - Pointer to a HunterArrayType structure representing the array of hunters
-in: hunter - Pointer to a HunterType structure representing the hunter to be removed
-*/
-void removeHunter(HunterArrayType *hunters_list, HunterType *hunter)
-{
-    int i;
-    // lock with semaphore
-    sem_wait(&hunters_list->sem);
-
-    for (i = 0; i < hunters_list->size; i++)
-    {
-        // Find the hunter to remove
-        if (strcmp(hunters_list->hunter[i].name, hunter->name) == 0)
-        {
-            // Replace the found hunter with the last hunter in the list
-            if (i != hunters_list->size - 1)
-            { // Check if it's not already the last hunter
-                hunters_list->hunter[i] = hunters_list->hunter[hunters_list->size - 1];
-            }
-            hunters_list->size--; // Decrease the size of the list
-            break;                // Exit the loop
-        }
-    }
-    // unlock the semaphore
-    sem_post(&hunters_list->sem);
-}
-
 /*
 Function: void freeHunter(HunterType *hunter)
 Purpose: Frees the memory allocated for a HunterType structure, including its evidence array.
@@ -0,0 +1,365 @@
+#include "defs.h"
+#include <sys/mman.h>
+
+typedef struct Lockstep LockstepType;
+
+// the text one game printed in a tick, a slice of its worker's turn output
+typedef struct LockstepPrinted {
+    int game;
+    size_t start;
+    size_t end;
+    int cut;
+} LockstepPrintedType;
+
+// one worker thread, worker i plays games i, i + numThreads and so on
+typedef struct LockstepWorker {
+    pthread_t thread;
+    LockstepType *lockstep;
+    //the worker's games still being played, lowest first
+    int *live;
+    int numLive;
+    long turns;
+    //games of the worker that ended in the last tick, lowest first
+    int *ended;
+    int numEnded;
+    //the next of them to be finished
+    int nextEnded;
+    //what the worker's games printed in the last tick, a slice per game that printed anything, lowest game first
+    TurnOutputType output;
+    size_t outputSize;
+    LockstepPrintedType *printed;
+    int numPrinted;
+    int nextPrinted;
+    //posted to play a tick, the worker posts done once it has
+    sem_t start;
+    sem_t *done;
+} __attribute__((aligned(CACHE_LINE))) LockstepWorkerType;
+
+// the games played in lockstep and the tick they are in, only written between ticks
+struct Lockstep {
+    CoopGameType *games;
+    //agents of each game still playing and the next tick one of them takes a turn in
+    int *playing;
+    long *due;
+    //LOG_CATEGORIES log records seen by each game
+    unsigned long *logCounts;
+    int numGames;
+    LockstepWorkerType *workers;
+    int numThreads;
+    long now;
+    int stopping;
+};
+
+/*
+Function: long playTick(CoopGameType *coopGame, int *playing, long now, long *turns)
+Purpose: Takes the turns of a game's agents that are due in a tick. They always go in the same order, the ghost and
+         then the hunters by id, so when two of them touch the same state, e.g. the same evidence, the one that goes
+         first is fixed by the rule and not by whichever thread got there first.
+in/out: coopGame - Pointer to the CoopGameType structure of the game
+in/out: playing - Number of the game's agents still playing, counted down as they finish
+in: now - The tick
+in/out: turns - Turns taken, added to
+return: Returns the next tick one of the game's agents takes a turn in
+*/
+static long playTick(CoopGameType *coopGame, int *playing, long now, long *turns)
+{
+    long due = -1;
+    for (int i = 0; i <= NUM_HUNTERS; i++)
+    {
+        AgentType *agent = &coopGame->agents[i];
+        if (agent->expires == now)
+        {
+            swapRandomState(&agent->seed);
+            int stillPlaying = agent->step(agent->context);
+            swapRandomState(&agent->seed);
+            (*turns)++;
+            // an agent that is done never expires again
+            agent->expires = stillPlaying ? now + agent->wait : -1;
+            *playing -= !stillPlaying;
+        }
+        if (agent->expires > now && (due < 0 || agent->expires < due))
+        {
+            due = agent->expires;
+        }
+    }
+    return due;
+}
+
+/*
+Function: void *lockstepWorker(void *param)
+Purpose: Plays the worker's share of the games one tick at a time, each time it is started, until it is stopped.
+         The games of a tick don't share any state, so the workers need no locking between them. What each game prints
+         goes to a slice of the worker's turn output of its own, at most LOCKSTEP_GAME_OUTPUT bytes a tick, to be
+         printed once the tick is over.
+in/out: param - Pointer to the LockstepWorkerType structure of the worker
+return: none
+*/
+static void *lockstepWorker(void *param)
+{
+    LockstepWorkerType *worker = (LockstepWorkerType *)param;
+    LockstepType *lockstep = worker->lockstep;
+    setTurnOutput(&worker->output);
+    while (C_TRUE)
+    {
+        sem_wait(&worker->start);
+        if (lockstep->stopping)
+        {
+            break;
+        }
+        // nothing in the game loop should need the heap
+        setAllocPhase(PHASE_RUN);
+        worker->numEnded = 0;
+        worker->numPrinted = 0;
+        worker->output.used = 0;
+        // games that end are dropped from the live list as it is walked, keeping the rest in order
+        int kept = 0;
+        for (int i = 0; i < worker->numLive; i++)
+        {
+            int game = worker->live[i];
+            if (lockstep->due[game] == lockstep->now)
+            {
+                TurnOutputType *output = &worker->output;
+                size_t start = output->used;
+                output->limit = start + LOCKSTEP_GAME_OUTPUT;
+                output->cut = C_FALSE;
+                output->logCounts = &lockstep->logCounts[(long)game * LOG_CATEGORIES];
+                lockstep->due[game] = playTick(&lockstep->games[game], &lockstep->playing[game], lockstep->now, &worker->turns);
+                if (output->used > start || output->cut)
+                {
+                    LockstepPrintedType *printed = &worker->printed[worker->numPrinted++];
+                    printed->game = game;
+                    printed->start = start;
+                    printed->end = output->used;
+                    printed->cut = output->cut;
+                }
+            }
+            if (lockstep->playing[game] == 0)
+            {
+                worker->ended[worker->numEnded++] = game;
+                continue;
+            }
+            worker->live[kept++] = game;
+        }
+        worker->numLive = kept;
+        setAllocPhase(PHASE_TEARDOWN);
+        sem_post(worker->done);
+    }
+    return NULL;
+}
+
+/*
+Function: void printTickOutput(LockstepType *lockstep)
+Purpose: Prints what the games printed in the last tick, lowest game first whichever worker played them, so the output
+         comes out in the same order for any number of workers.
+in/out: lockstep - Pointer to the LockstepType structure, between two ticks
+return: none
+*/
+static void printTickOutput(LockstepType *lockstep)
+{
+    for (int i = 0; i < lockstep->numThreads; i++)
+    {
+        lockstep->workers[i].nextPrinted = 0;
+    }
+    // each worker's slices are in game order already, so they are merged by always taking the lowest head
+    while (C_TRUE)
+    {
+        LockstepWorkerType *lowest = NULL;
+        for (int i = 0; i < lockstep->numThreads; i++)
+        {
+            LockstepWorkerType *worker = &lockstep->workers[i];
+            if (worker->nextPrinted < worker->numPrinted && (lowest == NULL || worker->printed[worker->nextPrinted].game < lowest->printed[lowest->nextPrinted].game))
+            {
+                lowest = worker;
+            }
+        }
+        if (lowest == NULL)
+        {
+            return;
+        }
+        LockstepPrintedType *printed = &lowest->printed[lowest->nextPrinted++];
+        fwrite(lowest->output.text + printed->start, 1, printed->end - printed->start, stdout);
+        if (printed->cut)
+        {
+            // the text can stop in the middle of a line
+            if (printed->end > printed->start && lowest->output.text[printed->end - 1] != '\n')
+            {
+                putchar('\n');
+            }
+            printf("Error: Game %u printed more than %d bytes in tick %ld, the rest was dropped\n",
+                   lockstep->games[printed->game].game.state.seed, LOCKSTEP_GAME_OUTPUT, lockstep->now);
+        }
+    }
+}
+
+/*
+Function: int finishEndedGames(LockstepType *lockstep, SimConfigType *config, int wins[])
+Purpose: Finishes the games that ended in the last tick, lowest game first whichever worker played them, so their
+         results are printed and recorded in the same order for any number of workers.
+in/out: lockstep - Pointer to the LockstepType structure, between two ticks
+in: config - Pointer to the SimConfigType structure the games were set up with
+in/out: wins - Array of RESULT_COUNT counts of games by how they ended, added to
+return: Returns the number of games finished
+*/
+static int finishEndedGames(LockstepType *lockstep, SimConfigType *config, int wins[])
+{
+    int finished = 0;
+    for (int i = 0; i < lockstep->numThreads; i++)
+    {
+        lockstep->workers[i].nextEnded = 0;
+    }
+    // each worker's list is in game order already, so they are merged by always taking the lowest head
+    while (C_TRUE)
+    {
+        LockstepWorkerType *lowest = NULL;
+        for (int i = 0; i < lockstep->numThreads; i++)
+        {
+            LockstepWorkerType *worker = &lockstep->workers[i];
+            if (worker->nextEnded < worker->numEnded && (lowest == NULL || worker->ended[worker->nextEnded] < lowest->ended[lowest->nextEnded]))
+            {
+                lowest = worker;
+            }
+        }
+        if (lowest == NULL)
+        {
+            return finished;
+        }
+        int game = lowest->ended[lowest->nextEnded++];
+        wins[finishGame(&lockstep->games[game].game, config)]++;
+        finished++;
+    }
+}
+
+/*
+Function: void runLockstep(SimConfigType *config, char hunterNames[][MAX_STR], int games, int numThreads, int wins[])
+Purpose: Plays a run of games all at once on numThreads worker threads that move from tick to tick together. In each
+         tick the workers take the turns of their games in parallel, then wait for each other before the next one; the
+         games that ended in the tick are finished in game order in between, after what the tick's turns printed has
+         been printed in game order. Every game's turns go in a fixed order within a tick, its random numbers come
+         from its own agents' streams and its log is sampled by counts of its own, so the whole run, output, results
+         records and sketches included, comes out the same for any number of workers. Only the timing line differs.
+in/out: config - Pointer to the SimConfigType structure, game i is seeded with its seed plus i
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: games - Number of games to play
+in: numThreads - Number of worker threads
+in/out: wins - Array of RESULT_COUNT counts of games by how they ended, added to
+return: none
+*/
+void runLockstep(SimConfigType *config, char hunterNames[][MAX_STR], int games, int numThreads, int wins[])
+{
+    LockstepType lockstep;
+    lockstep.numGames = games;
+    lockstep.numThreads = numThreads;
+    lockstep.now = 0;
+    lockstep.stopping = C_FALSE;
+    lockstep.games = malloc(games * sizeof(CoopGameType));
+    lockstep.playing = malloc(games * sizeof(int));
+    lockstep.due = malloc(games * sizeof(long));
+    lockstep.logCounts = calloc((long)games * LOG_CATEGORIES, sizeof(unsigned long));
+    lockstep.workers = aligned_alloc(CACHE_LINE, numThreads * sizeof(LockstepWorkerType));
+    if (lockstep.games == NULL || lockstep.playing == NULL || lockstep.due == NULL || lockstep.logCounts == NULL || lockstep.workers == NULL)
+    {
+        printf("Error allocating memory for games\n");
+        exit(1);
+    }
+
+    unsigned int seed = config->seed;
+    for (int i = 0; i < games; i++)
+    {
+        config->seed = seed + i;
+        initCoopGame(&lockstep.games[i], config, hunterNames);
+        for (int agent = 0; agent <= NUM_HUNTERS; agent++)
+        {
+            // every agent takes its first turn in the first tick
+            lockstep.games[i].agents[agent].expires = 1;
+        }
+        lockstep.playing[i] = NUM_HUNTERS + 1;
+        lockstep.due[i] = 1;
+        if (config->stats != NULL)
+        {
+            setStatsRooms(config->stats, &lockstep.games[i].game.house);
+        }
+    }
+    config->seed = seed;
+
+    sem_t done;
+    sem_init(&done, 0, 0);
+    for (int i = 0; i < numThreads; i++)
+    {
+        LockstepWorkerType *worker = &lockstep.workers[i];
+        worker->lockstep = &lockstep;
+        worker->turns = 0;
+        worker->numEnded = 0;
+        // a worker can't end more games in a tick than it plays
+        worker->live = malloc((games / numThreads + 1) * sizeof(int));
+        worker->ended = malloc((games / numThreads + 1) * sizeof(int));
+        worker->printed = malloc((games / numThreads + 1) * sizeof(LockstepPrintedType));
+        if (worker->live == NULL || worker->ended == NULL || worker->printed == NULL)
+        {
+            printf("Error allocating memory for games\n");
+            exit(1);
+        }
+        // room for every game to print its most in one tick, only the pages written to are ever backed by memory
+        worker->outputSize = (games / numThreads + 1) * (size_t)LOCKSTEP_GAME_OUTPUT;
+        worker->output.text = mmap(NULL, worker->outputSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (worker->output.text == MAP_FAILED)
+        {
+            printf("Error mapping memory for game output\n");
+            exit(1);
+        }
+        worker->output.used = 0;
+        worker->numPrinted = 0;
+        worker->numLive = 0;
+        for (int game = i; game < games; game += numThreads)
+        {
+            worker->live[worker->numLive++] = game;
+        }
+        sem_init(&worker->start, 0, 0);
+        worker->done = &done;
+        createPinnedThread(&config->placement, &worker->thread, getWorkerCore(&config->placement, i), lockstepWorker, worker);
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int left = games; left > 0;)
+    {
+        lockstep.now++;
+        for (int i = 0; i < numThreads; i++)
+        {
+            sem_post(&lockstep.workers[i].start);
+        }
+        for (int i = 0; i < numThreads; i++)
+        {
+            sem_wait(&done);
+        }
+        setAllocPhase(PHASE_TEARDOWN);
+        printTickOutput(&lockstep);
+        left -= finishEndedGames(&lockstep, config, wins);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    lockstep.stopping = C_TRUE;
+    long turns = 0;
+    for (int i = 0; i < numThreads; i++)
+    {
+        LockstepWorkerType *worker = &lockstep.workers[i];
+        sem_post(&worker->start);
+        pthread_join(worker->thread, NULL);
+        sem_destroy(&worker->start);
+        turns += worker->turns;
+        free(worker->live);
+        free(worker->ended);
+        free(worker->printed);
+        munmap(worker->output.text, worker->outputSize);
+    }
+    sem_destroy(&done);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("\n%d games in lockstep on %d threads took %ld turns over %ld ticks in %.2f s (%.0f ns a turn)\n",
+           games, numThreads, turns, lockstep.now, seconds, seconds * 1e9 / (turns > 0 ? turns : 1));
+    free(lockstep.workers);
+    free(lockstep.due);
+    free(lockstep.logCounts);
+    free(lockstep.playing);
+    free(lockstep.games);
+}
@@ -1,4 +1,91 @@
 #include "defs.h"
+#include <stdarg.h>
+
+// 1 in how many records of each category are printed, 0 to print none
+static long logRates[LOG_CATEGORIES] = { 1, 1, 1, 1, 1, 1 };
+// records seen per category, shared by every thread so a replay samples the same records
+static unsigned long logCounts[LOG_CATEGORIES];
+// where this thread's turns print, NULL for straight to stdout
+static __thread TurnOutputType *turnOutput = NULL;
+static const char *logCategoryNames[LOG_CATEGORIES] = { "init", "hunter-move", "ghost-move", "evidence", "review", "exit" };
+
+/*
+    Decides if a record of a category gets printed, counting it towards the category's sampling rate.
+    in: category - the category of the record
+    return: C_TRUE if the record should be printed
+*/
+int logSampled(enum LogCategory category) {
+    long rate = logRates[category];
+    if (rate <= 1) {
+        return rate == 1;
+    }
+    unsigned long *counts = turnOutput != NULL && turnOutput->logCounts != NULL ? turnOutput->logCounts : logCounts;
+    return __atomic_fetch_add(&counts[category], 1, __ATOMIC_RELAXED) % rate == 0;
+}
+
+/*
+    Sends what this thread's turns print to a buffer instead of stdout, or back to stdout.
+    in: output - the buffer, NULL for stdout
+*/
+void setTurnOutput(TurnOutputType *output) {
+    turnOutput = output;
+}
+
+/*
+    Prints a line of a turn, to this thread's turn output if it has one. Text that doesn't fit in the space left for
+    the game being played is dropped and the game's output marked as cut. Nothing is allocated either way.
+    in: format - printf style format, followed by its arguments
+*/
+void printTurn(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (turnOutput == NULL) {
+        vprintf(format, args);
+    }
+    else {
+        size_t space = turnOutput->limit - turnOutput->used;
+        int length = vsnprintf(turnOutput->text + turnOutput->used, space, format, args);
+        if (length >= 0 && (size_t)length < space) {
+            turnOutput->used += length;
+        }
+        else {
+            turnOutput->cut = C_TRUE;
+        }
+    }
+    va_end(args);
+}
+
+/*
+    Sets the runtime filter from a list such as "hunter-move=1000,ghost-move=0,evidence=1".
+    Each entry prints 1 in N records of the category, 0 turns it off. "all" sets every category.
+    in: spec - the list of category=rate entries
+    return: 0 on success, -1 if the list can't be read
+*/
+int setLogFilter(const char *spec) {
+    char buffer[MAX_STR * 4];
+    snprintf(buffer, sizeof(buffer), "%s", spec);
+    for (char *entry = strtok(buffer, ","); entry != NULL; entry = strtok(NULL, ",")) {
+        char *equals = strchr(entry, '=');
+        if (equals == NULL) {
+            printf("Error: Log filter entry [%s] should be category=rate\n", entry);
+            return -1;
+        }
+        *equals = '\0';
+        long rate = atol(equals + 1);
+        int found = C_FALSE;
+        for (int category = 0; category < LOG_CATEGORIES; category++) {
+            if (strcmp(entry, "all") == 0 || strcmp(entry, logCategoryNames[category]) == 0) {
+                logRates[category] = rate;
+                found = C_TRUE;
+            }
+        }
+        if (!found) {
+            printf("Error: Unknown log category [%s]\n", entry);
+            return -1;
+        }
+    }
+    return 0;
+}
 
 /* 
     Logs the hunter being created.
@@ -9,7 +96,7 @@ void l_hunterInit(char* hunter, enum EvidenceType equipment) {
     if (!LOGGING) return;
     char ev_str[MAX_STR];
     evidenceToString(equipment, ev_str);
-    printf("[HUNTER INIT] [%s] is a [%s] hunter\n", hunter, ev_str);    
+    printTurn("[HUNTER INIT] [%s] is a [%s] hunter\n", hunter, ev_str);    
 }
 
 /*
@@ -19,7 +106,7 @@ void l_hunterInit(char* hunter, enum EvidenceType equipment) {
 */
 void l_hunterMove(char* hunter, char* room) {
     if (!LOGGING) return;
-    printf("[HUNTER MOVE] [%s] has moved into [%s]\n", hunter, room);
+    printTurn("[HUNTER MOVE] [%s] has moved into [%s]\n", hunter, room);
 }
 
 /*
@@ -29,19 +116,19 @@ void l_hunterMove(char* hunter, char* room) {
 */
 void l_hunterExit(char* hunter, enum LoggerDetails reason) {
     if (!LOGGING) return;
-    printf("[HUNTER EXIT] [%s] exited because ", hunter);
+    printTurn("[HUNTER EXIT] [%s] exited because ", hunter);
     switch (reason) {
         case LOG_FEAR:
-            printf("[FEAR]\n");
+            printTurn("[FEAR]\n");
             break;
         case LOG_BORED:
-            printf("[BORED]\n");
+            printTurn("[BORED]\n");
             break;
         case LOG_EVIDENCE:
-            printf("[EVIDENCE]\n");
+            printTurn("[EVIDENCE]\n");
             break;
         default:
-            printf("[UNKNOWN]\n");
+            printTurn("[UNKNOWN]\n");
     }
 }
 
@@ -52,16 +139,16 @@ void l_hunterExit(char* hunter, enum LoggerDetails reason) {
 */
 void l_hunterReview(char* hunter, enum LoggerDetails result) {
     if (!LOGGING) return;
-    printf("[HUNTER REVIEW] [%s] reviewed evidence and found ", hunter);
+    printTurn("[HUNTER REVIEW] [%s] reviewed evidence and found ", hunter);
     switch (result) {
         case LOG_SUFFICIENT:
-            printf("[SUFFICIENT]\n");
+            printTurn("[SUFFICIENT]\n");
             break;
         case LOG_INSUFFICIENT:
-            printf("[INSUFFICIENT]\n");
+            printTurn("[INSUFFICIENT]\n");
             break;
         default:
-            printf("[UNKNOWN]\n");
+            printTurn("[UNKNOWN]\n");
     }
 }
 
@@ -75,7 +162,41 @@ void l_hunterCollect(char* hunter, enum EvidenceType evidence, char* room) {
     if (!LOGGING) return;
     char ev_str[MAX_STR];
     evidenceToString(evidence, ev_str);
-    printf("[HUNTER EVIDENCE] [%s] found [%s] in [%s] and [COLLECTED]\n", hunter, ev_str, room);
+    printTurn("[HUNTER EVIDENCE] [%s] found [%s] in [%s] and [COLLECTED]\n", hunter, ev_str, room);
+}
+
+/*
+    Logs a hunter finding evidence the shared evidence array wouldn't take, because that type is already collected
+    or the array is full.
+    in: hunter - the hunter name to log
+*/
+void l_hunterCollectFailed(char* hunter) {
+    if (!LOGGING) return;
+    printTurn("[HUNTER EVIDENCE] [%s] failed to add evidence to shared array\n", hunter);
+}
+
+/*
+    Logs the shared evidence array turning evidence away because it is full.
+*/
+void l_evidenceFull(void) {
+    if (!LOGGING) return;
+    printTurn("Error: Evidence array is full\n");
+}
+
+/*
+    Logs what a review of three pieces of evidence made of the ghost.
+    in: identified - the ghost type the evidence points to
+    in: correct - C_TRUE if that is the ghost's type
+*/
+void l_ghostIdentified(enum GhostClass identified, int correct) {
+    if (!LOGGING) return;
+    if (!correct) {
+        printTurn("Incorrect ghost type. Further investigation needed.\n");
+        return;
+    }
+    char ghost_str[MAX_STR];
+    ghostToString(identified, ghost_str);
+    printTurn("Correctly identified the ghost type as %s!\n", ghost_str);
 }
 
 /*
@@ -84,7 +205,7 @@ void l_hunterCollect(char* hunter, enum EvidenceType evidence, char* room) {
 */
 void l_ghostMove(char* room) {
     if (!LOGGING) return;
-    printf("[GHOST MOVE] Ghost has moved into [%s]\n", room);
+    printTurn("[GHOST MOVE] Ghost has moved into [%s]\n", room);
 }
 
 /*
@@ -93,19 +214,19 @@ void l_ghostMove(char* room) {
 */
 void l_ghostExit(enum LoggerDetails reason) {
     if (!LOGGING) return;
-    printf("[GHOST EXIT] Exited because ");
+    printTurn("[GHOST EXIT] Exited because ");
     switch (reason) {
         case LOG_FEAR:
-            printf("[FEAR]\n");
+            printTurn("[FEAR]\n");
             break;
         case LOG_BORED:
-            printf("[BORED]\n");
+            printTurn("[BORED]\n");
             break;
         case LOG_EVIDENCE:
-            printf("[EVIDENCE]\n");
+            printTurn("[EVIDENCE]\n");
             break;
         default:
-            printf("[UNKNOWN]\n");
+            printTurn("[UNKNOWN]\n");
     }
 }
 
@@ -118,7 +239,7 @@ void l_ghostEvidence(enum EvidenceType evidence, char* room) {
     if (!LOGGING) return;
     char ev_str[MAX_STR];
     evidenceToString(evidence, ev_str);
-    printf("[GHOST EVIDENCE] Ghost left [%s] in [%s]\n", ev_str, room);
+    printTurn("[GHOST EVIDENCE] Ghost left [%s] in [%s]\n", ev_str, room);
 }
 
 /*
@@ -130,5 +251,15 @@ void l_ghostInit(enum GhostClass ghost, char* room) {
     if (!LOGGING) return;
     char ghost_str[MAX_STR];
     ghostToString(ghost, ghost_str);
-    printf("[GHOST INIT] Ghost is a [%s] in room [%s]\n", ghost_str, room);
-}
\ No newline at end of file
+    printTurn("[GHOST INIT] Ghost is a [%s] in room [%s]\n", ghost_str, room);
+}
+/*
+    Logs where a simulation thread has been placed.
+    in: name - the name of the thread to log
+    in: core - the core the thread is pinned to
+    in: node - the NUMA node of that core
+*/
+void l_placement(char* name, int core, int node) {
+    if (!LOGGING) return;
+    printf("[PLACEMENT] [%s] pinned to core [%d] on node [%d]\n", name, core, node);
+}
@@ -1,153 +1,483 @@
 #include "defs.h"
+#include <math.h>
+#include <fcntl.h>
 
-// main function
-int main() {
-    // Initialize the random number generator
-    // Populate the house with the provided rooms
+/*
+Function: void printCheck(const char *name, double exact, double played, double error, int *passed)
+Purpose: Prints one line of the analytic check: the exact answer, what the engine's games gave and how many standard
+         errors apart they are, failing the check when that is more than MARKOV_CHECK_SIGMAS.
+in: name - Label of the line
+in: exact - The exact answer
+in: played - The engine's average over its games
+in: error - Standard error of the engine's average
+in/out: passed - Cleared if the line fails the check
+return: none
+*/
+static void printCheck(const char *name, double exact, double played, double error, int *passed) {
+    double sigmas = error > 0 ? (played - exact) / error : 0;
+    if (sigmas > MARKOV_CHECK_SIGMAS || sigmas < -MARKOV_CHECK_SIGMAS || (error == 0 && played != exact)) {
+        *passed = C_FALSE;
+    }
+    printf("%-17s%10.4f%10.4f%10.4f%8.2f\n", name, exact, played, error, sigmas);
+}
+
+/*
+Function: int solveHouse(SimConfigType *config, int games, int numThreads)
+Purpose: Solves the party game ('--party' with evidence fading after --fade ghost updates, MARKOV_MAX_FADE by
+         default) on the default house exactly, then plays it on the engine with the scheduler of '--coop' and
+         checks the engine's endings and mean length are within MARKOV_CHECK_SIGMAS standard errors of the exact ones.
+in/out: config - Pointer to the SimConfigType structure holding the simulation options, set up for the party game
+in: games - Number of games the engine plays for the check
+in: numThreads - Number of threads for the solver and the games
+return: Returns 0 if the check passed, 1 if it failed
+*/
+static int solveHouse(SimConfigType *config, int games, int numThreads) {
     HouseType house;
     initHouse(&house);
     populateRooms(&house);
-    // Place the ghost in a random room, that is not the van
-    //allocate memory for the ghost
-    GhostType *ghost = malloc(sizeof(GhostType));
-    RoomType* randomRoom = getRandomRoomExcludeVan(&house);  // You need to implement this function
-    initGhost(ghost, randomGhost(), randomRoom);
+    long fadeTime = config->fadeTime > 0 ? config->fadeTime : MARKOV_MAX_FADE;
 
-    // Ask the user to input 4 names for our hunters
-    char hunterNames[NUM_HUNTERS][MAX_STR];  // Assuming NUM_HUNTERS is 4
-    for (int i = 0; i < NUM_HUNTERS; i++) {
-        printf("Enter name for hunter %d: ", i + 1);
-        fgets(hunterNames[i], MAX_STR, stdin);
-        hunterNames[i][strcspn(hunterNames[i], "\n")] = 0;  // Remove newline character
+    MarkovModelType *model = malloc(sizeof(MarkovModelType));
+    if (model == NULL) {
+        printf("Error allocating memory for markov model\n");
+        exit(1);
     }
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    initMarkovModel(model, &house, fadeTime);
+    buildMarkovModel(model);
 
-    //creating initial room hunter should be in 
-    RoomType* vanRoom = house.rooms->rhead->room;  // Assuming the Van room is the head of the room list
+    double winProb[RESULT_COUNT];
+    double expectedLength;
+    double lengthDeviation;
+    solveMarkovModel(model, numThreads, winProb, &expectedLength, &lengthDeviation);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double milliseconds = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
 
-    // Create a hunter for each name and add them to the house and initialize 
+    // the same game on the engine, quietly: no log and the games' tallies go to /dev/null
+    config->hunterPolicy = POLICY_PARTY;
+    config->fadeTime = fadeTime;
+    setLogFilter("all=0");
+    GameSketchType sketch;
+    initGameSketch(&sketch);
+    config->sketch = &sketch;
+    char hunterNames[NUM_HUNTERS][MAX_STR];
     for (int i = 0; i < NUM_HUNTERS; i++) {
-        HunterType hunter;
-        initHunter(&hunter, hunterNames[i], EV_UNKNOWN, vanRoom);
-        addHunter(house.hunterArray, &hunter);
-        //add hunters to the vanRoom hunter array list
-        addHunter(vanRoom->hunterArray, &hunter);
-
+        snprintf(hunterNames[i], MAX_STR, "Hunter %d", i + 1);
+    }
+    int wins[RESULT_COUNT] = {0};
+    WorkerPoolType pool;
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (savedStdout < 0 || devNull < 0) {
+        printf("Error opening /dev/null for the check's games\n");
+        exit(1);
     }
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+    startWorkerPool(&pool, numThreads, &config->placement);
+    runCoopGames(config, hunterNames, games, &pool, wins, NULL, NULL);
+    stopWorkerPool(&pool);
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
 
-    // Assign random equipment to each hunter
-    assignRandomEquipment(house.hunterArray, house.hunterArray->size);  // You need to implement this function
-    
-    for (int i = 0; i < NUM_HUNTERS; i++) {
-        l_hunterInit(house.hunterArray->hunter[i].name, house.hunterArray->hunter[i].equipment);
+    printf("Exact results of '--party --fade %ld' over %d states and %d transitions (built and solved in %.0f ms on %d threads)\n",
+           fadeTime, model->numStates, model->transitions.nonZeros, milliseconds, model->numWorkers);
+    printf("checked against %d games the engine played with '--coop' from seed %u\n", games, config->seed);
+    printf("=================================\n");
+    printf("%-17s%10s%10s%10s%8s\n", "", "exact", "engine", "std err", "sigmas");
+    static const char *endings[RESULT_COUNT] = { "Hunters won:", "Ghost won:", "Ghost got bored:" };
+    int passed = C_TRUE;
+    for (int i = 0; i < RESULT_COUNT; i++) {
+        printCheck(endings[i], winProb[i], (double)wins[i] / games, sqrt(winProb[i] * (1 - winProb[i]) / games), &passed);
     }
+    SketchType *lengths = &sketch.measures[MEASURE_LENGTH];
+    printCheck("Expected length:", expectedLength, (double)lengths->sum / lengths->count, lengthDeviation / sqrt(games), &passed);
+    printf("Lengths are in ghost updates (%.1f ms each)\n", GHOST_WAIT / 1000.0);
+    printf(passed ? "Check passed: the engine is within %d standard errors of the exact answers\n"
+                  : "Check failed: the engine is more than %d standard errors from an exact answer\n", MARKOV_CHECK_SIGMAS);
 
-    // Initialize the shared game state
-    SharedGameState gameState;
-    gameState.gameOver = 0; // Game starts with not being over
+    freeMarkovModel(model);
+    free(model);
+    freeHouse(&house);
+    return passed ? 0 : 1;
+}
 
-    // Create threads
-    pthread_t hunterThreads[NUM_HUNTERS];
-    pthread_t ghostThread;
+/*
+Function: void printResults(int wins[], int games, GameSketchType *sketch)
+Purpose: Prints the percentiles of the games' lengths and exit times, then how often each ending happened over a run of games.
+in: wins - Array of RESULT_COUNT counts of games by how they ended
+in: games - Number of games played
+in: sketch - Pointer to the GameSketchType structure the games were counted in
+return: none
+*/
+static void printResults(int wins[], int games, GameSketchType *sketch) {
+    printGameSketch(sketch);
+    printf("\nResults over %d games\n", games);
+    printf("=================================\n");
+    printf("Hunters won:     %.4f\n", (double)wins[RESULT_HUNTERS_WIN] / games);
+    printf("Ghost won:       %.4f\n", (double)wins[RESULT_GHOST_WINS] / games);
+    printf("Ghost got bored: %.4f\n", (double)wins[RESULT_GHOST_BORED] / games);
+}
 
+// stdout's buffer, given up front so the first line printed from the game loop doesn't allocate one
+static char outputBuffer[BUFSIZ];
 
-    // Initialize ghostContext fields...
-    GhostBehaviorContext *ghostContext = malloc(sizeof(GhostBehaviorContext));
-    if (ghostContext == NULL) {
-        printf("Failed to allocate memory for ghost context\n");
-        // Handle allocation error
-        return 1;
-    }
-    
-    // Initialize ghostContext fields
-    initGhostBehaviorContext(ghostContext, ghost, &house, house.hunterArray, &gameState);
-    pthread_create(&ghostThread, NULL, ghostBehav, (void *)ghostContext);
-    
-    // Create one thread for each hunter
-    HunterBehaviorContext *hunterContexts[NUM_HUNTERS];  // Array to store contexts
+// main function
+int main(int argc, char *argv[]) {
+    setvbuf(stdout, outputBuffer, isatty(STDOUT_FILENO) ? _IOLBF : _IOFBF, sizeof(outputBuffer));
 
-    for (int i = 0; i < NUM_HUNTERS; i++) {
-        hunterContexts[i] = malloc(sizeof(HunterBehaviorContext));
-        if (hunterContexts[i] == NULL) {
-            printf("Failed to allocate memory for hunter context\n");
-            // Handle allocation error
+    // Read the command line options
+    // --pin pins the simulation threads to cores
+    // --games N plays N games in a row with generated hunter names
+    // --stats publishes live counters to shared memory for fpstat
+    // --analytic solves the party game exactly and checks the engine against it, --games N of them (20000 by default)
+    // --rooms N plays in a generated house of N rooms
+    // --frontier makes hunters head for rooms they haven't visited
+    // --tracker makes hunters head for the closest room holding the evidence their equipment finds
+    // --party makes the hunters search together, taking one turn for the whole party
+    // --fade N keeps a bounded ring of evidence per room that fades after N ghost updates
+    // --record FILE saves every turn and random draw of the games to FILE
+    // --replay FILE plays the games saved in FILE again, turn for turn
+    // --scaling measures hunter updates per second from 1 to 64 threads for both hunter layouts
+    // --ghostreads measures how fast 1 to 1000 hunter threads read the ghost while it moves
+    // --doorway measures how fast 1 to 64 hunter threads cross one doorway and checks no move is seen half done
+    // --evidenceindex checks the evidence index against a walk over every room and times both
+    // --results FILE appends a record of every finished game to the columnar results file FILE
+    // --seed N seeds the first game with N, each following game with the next number
+    // --coop N plays every game of --games at once as agents of a scheduler running on N threads
+    // --serve PATH runs jobs sent to the Unix socket PATH on --coop N warm worker threads, one per core by default
+    // --realtime paces every turn on absolute deadlines and reports how late the turns started
+    // --spin N spins for the last N microseconds before each deadline instead of sleeping, implies --realtime
+    // --log SPEC prints 1 in N records of each log category, e.g. hunter-move=1000,ghost-move=0
+    // --city N plays --games games in each of N houses at once on --coop N threads, one per core by default
+    // --procs N plays the games of --games on N worker processes that pull batches from shared memory
+    // --branch K plays a game up to the --at point, then plays it out K times from there, --procs N at a time
+    // --lockstep N plays every game of --games at once on N threads that take each tick together, the same for any N
+    // --at POINT pauses the game to branch at dropped, collected, exit or a clock, dropped by default
+    int pinThreads = C_FALSE;
+    int publishStats = C_FALSE;
+    int analytic = C_FALSE;
+    int scaling = C_FALSE;
+    int ghostReads = C_FALSE;
+    int doorway = C_FALSE;
+    int evidenceIndex = C_FALSE;
+    int numRooms = 0;
+    HunterPolicy hunterPolicy = POLICY_RANDOM;
+    long fadeTime = 0;
+    int games = 0;
+    int coopThreads = 0;
+    int numHouses = 0;
+    int numProcs = 0;
+    int branches = 0;
+    int lockstepThreads = 0;
+    const char *branchAt = "dropped";
+    int realtime = C_FALSE;
+    long spinTime = 0;
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    const char *resultsPath = NULL;
+    const char *servePath = NULL;
+    unsigned int seed = (unsigned int)time(NULL);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pin") == 0) {
+            pinThreads = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            publishStats = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--analytic") == 0) {
+            analytic = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--scaling") == 0) {
+            scaling = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--ghostreads") == 0) {
+            ghostReads = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--doorway") == 0) {
+            doorway = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--evidenceindex") == 0) {
+            evidenceIndex = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--rooms") == 0 && i + 1 < argc) {
+            numRooms = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--frontier") == 0) {
+            hunterPolicy = POLICY_FRONTIER;
+        }
+        else if (strcmp(argv[i], "--tracker") == 0) {
+            hunterPolicy = POLICY_TRACKER;
+        }
+        else if (strcmp(argv[i], "--party") == 0) {
+            hunterPolicy = POLICY_PARTY;
+        }
+        else if (strcmp(argv[i], "--fade") == 0 && i + 1 < argc) {
+            fadeTime = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            resultsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--coop") == 0 && i + 1 < argc) {
+            coopThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--city") == 0 && i + 1 < argc) {
+            numHouses = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--procs") == 0 && i + 1 < argc) {
+            numProcs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--branch") == 0 && i + 1 < argc) {
+            branches = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--lockstep") == 0 && i + 1 < argc) {
+            lockstepThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--at") == 0 && i + 1 < argc) {
+            branchAt = argv[++i];
+        }
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            servePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--realtime") == 0) {
+            realtime = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--spin") == 0 && i + 1 < argc) {
+            spinTime = atol(argv[++i]);
+            realtime = C_TRUE;
+        }
+        else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            if (setLogFilter(argv[++i]) != 0) {
+                return 1;
+            }
+        }
+        else {
+            printf("Usage: %s [--pin] [--games N] [--stats] [--analytic] [--rooms N] [--frontier] [--tracker] [--party] [--fade N] [--record FILE] [--replay FILE] [--scaling] [--ghostreads] [--doorway] [--evidenceindex] [--results FILE] [--seed N] [--coop N] [--serve PATH] [--realtime] [--spin N] [--log SPEC] [--city N] [--procs N] [--branch K] [--at POINT] [--lockstep N]\n", argv[0]);
             return 1;
         }
-        // Initialize hunterContext fields
-        initHunterBehaviorContext(hunterContexts[i], &house.hunterArray->hunter[i], ghost, &house, house.evidenceArray, &gameState);
-        
-        // Create thread
-        pthread_create(&hunterThreads[i], NULL, hunterBehav, (void *)hunterContexts[i]);
     }
 
-    // Join threads and free their contexts
-    pthread_join(ghostThread, NULL);
-
-    for (int i = 0; i < NUM_HUNTERS; i++) {
-        // joining the thread
-        pthread_join(hunterThreads[i], NULL);
+    if (analytic && numRooms > 0) {
+        printf("Error: --analytic only solves the default house\n");
+        return 1;
+    }
+    if (coopThreads > 0 && servePath == NULL && !analytic && (games <= 0 || recordPath != NULL || replayPath != NULL)) {
+        printf("Error: --coop needs --games and can't be recorded or replayed\n");
+        return 1;
+    }
+    if (numHouses > 0 && (servePath != NULL || recordPath != NULL || replayPath != NULL)) {
+        printf("Error: --city can't be served, recorded or replayed\n");
+        return 1;
+    }
+    if (lockstepThreads > 0 && (games <= 0 || coopThreads > 0 || numHouses > 0 || numProcs > 0 || branches > 0 || servePath != NULL || recordPath != NULL || replayPath != NULL || realtime)) {
+        printf("Error: --lockstep needs --games and can't be mixed with --coop, --city, --procs, --branch, --serve, --realtime or be recorded or replayed\n");
+        return 1;
+    }
+    BranchPointType branchPoint;
+    if (branches > 0 && (games > 0 || coopThreads > 0 || numHouses > 0 || servePath != NULL || recordPath != NULL || replayPath != NULL || publishStats || realtime)) {
+        printf("Error: --branch plays a single game and can't be mixed with --games, --coop, --city, --serve, --stats, --realtime or be recorded or replayed\n");
+        return 1;
+    }
+    if (branches > 0 && parseBranchPoint(branchAt, &branchPoint) != 0) {
+        return 1;
+    }
+    if (numProcs > 0 && branches <= 0 && (games <= 0 || coopThreads > 0 || numHouses > 0 || servePath != NULL || recordPath != NULL || replayPath != NULL || publishStats)) {
+        printf("Error: --procs needs --games and can't be mixed with --coop, --city, --serve, --stats or be recorded or replayed\n");
+        return 1;
+    }
+    if (hunterPolicy == POLICY_PARTY && !analytic && servePath == NULL && coopThreads <= 0 && lockstepThreads <= 0 && numHouses <= 0 && numProcs <= 0 && branches <= 0) {
+        printf("Error: --party needs one thread to take all of a game's turns, with --coop, --lockstep, --city, --procs or --branch\n");
+        return 1;
+    }
+    if (realtime && (coopThreads > 0 || numHouses > 0 || numProcs > 0 || servePath != NULL || replayPath != NULL)) {
+        printf("Error: --realtime only paces games played on their own threads\n");
+        return 1;
     }
 
-    //temp variables to count the fear and boredom
-    int fear_count = 0;
-    int boredom_count_hunter = 0;
-    printf("\nAll done! Let's tally the results...\n");
-    printf("=================================\n");
+    SimConfigType config;
+    // Detect the cores and NUMA nodes of the machine
+    initPlacement(&config.placement, pinThreads);
 
-    //analyze each hunter fear 
-    if(house.hunterArray->size == 0){
-        printf("There are no hunters left in the house\n");
-        fear_count = NUM_HUNTERS;
+    if (scaling) {
+        runScalingBenchmark(&config.placement);
+        return 0;
     }
-    else{
-        for(int i = 0; i < house.hunterArray->size; i++){
-            if(house.hunterArray->hunter[i].fear >= FEAR_MAX){
-                printf("%s has been scared out of the house\n", house.hunterArray->hunter[i].name);
-                fear_count++;
-            }
+    if (ghostReads) {
+        runGhostReadBenchmark(&config.placement);
+        return 0;
+    }
+    if (doorway) {
+        runDoorwayBenchmark(&config.placement);
+        return 0;
+    }
+    if (evidenceIndex) {
+        runEvidenceIndexBenchmark();
+        return 0;
+    }
+    // the dwell table fits the generated houses, or the default house and daemon jobs up to MAX_ROOMS rooms
+    config.stats = publishStats ? openStats(numRooms > MAX_ROOMS ? numRooms : MAX_ROOMS) : NULL;
+    config.hunterPolicy = hunterPolicy;
+    config.numRooms = numRooms;
+    config.fadeTime = fadeTime;
+    config.seed = seed;
+    // houses go on the node of the first worker, the ghost's core when each game has its own threads
+    config.node = getCoreNode(&config.placement, getWorkerCore(&config.placement, 0));
+    config.results = NULL;
+    config.pacers = NULL;
+    // a fixed size whatever the number of games, filled in by whichever thread finishes them
+    GameSketchType sketch;
+    initGameSketch(&sketch);
+    config.sketch = servePath == NULL ? &sketch : NULL;
+    // the default house is built once and copied for every game
+    config.house = createHouseTemplate(0);
+    if (realtime) {
+        config.pacers = malloc((NUM_HUNTERS + 1) * sizeof(PacerType));
+        if (config.pacers == NULL) {
+            printf("Error allocating memory for pacers\n");
+            exit(1);
+        }
+        for (int i = 0; i <= NUM_HUNTERS; i++) {
+            initPacer(&config.pacers[i], spinTime);
         }
-
     }
-
-    //analyze each hunter boredom
-    for(int i = 0; i < house.hunterArray->size; i++){
-        if(house.hunterArray->hunter[i].boredom >= BOREDOM_MAX){
-            printf("%s has gotten bored and left the house\n", house.hunterArray->hunter[i].name);
-            boredom_count_hunter++;
+    if (resultsPath != NULL) {
+        config.results = openResults(resultsPath);
+        if (config.results == NULL) {
+            return 1;
         }
     }
 
-    //print the evidence that has been collected
-    char ev[3][MAX_STR];
-    printf("The evidence collected is: \n");
-    for(int i = 0; i < house.evidenceArray->size; i++){
-        evidenceToString(house.evidenceArray->evidence[i], ev[i]);
-        printf("%s\n", ev[i]);
+    char hunterNames[NUM_HUNTERS][MAX_STR];  // Assuming NUM_HUNTERS is 4
+    int status = 0;
+    if (analytic) {
+        // The exact answers are checked against the engine playing the same game
+        status = solveHouse(&config, games > 0 ? games : MARKOV_CHECK_GAMES, coopThreads > 0 ? coopThreads : config.placement.numCores);
     }
-
-    printf("\n"); 
-    // Check if the ghost has won
-    if (fear_count  == NUM_HUNTERS || boredom_count_hunter == NUM_HUNTERS || house.hunterCount == 0) {
-        printf("The ghost has won the game!\n");
-    } 
-    // Check if the hunters have won
-    else if(house.evidenceArray->size == 3) 
-    {
-        printf("The hunters have won the game!\n");
-        reviewEvidence(house.evidenceArray, ghost);
-
+    else if (servePath != NULL) {
+        // Jobs bring their own options and seeds, the workers stay up between them
+        if (runDaemon(&config, servePath, coopThreads > 0 ? coopThreads : config.placement.numCores) != 0) {
+            return 1;
+        }
+    }
+    else if (replayPath != NULL) {
+        // The recording knows the house, hunters and options it was played with
+        if (openReplay(replayPath, &config, hunterNames) != 0) {
+            return 1;
+        }
+        int wins[RESULT_COUNT] = {0};
+        games = 0;
+        while (moreReplayGames()) {
+            config.seed = seed + games;
+            wins[runGame(&config, hunterNames)]++;
+            games++;
+        }
+        closeRecording();
+        if (games > 1) {
+            printResults(wins, games, config.sketch);
+        }
+    }
+    else if (numHouses > 0) {
+        // Every house of the city plays on its own worker, one game of each by default
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            snprintf(hunterNames[i], MAX_STR, "Hunter %d", i + 1);
+        }
+        int gamesPerHouse = games > 0 ? games : 1;
+        int wins[RESULT_COUNT] = {0};
+        WorkerPoolType pool;
+        startWorkerPool(&pool, coopThreads > 0 ? coopThreads : config.placement.numCores, &config.placement);
+        runCity(&config, hunterNames, numHouses, gamesPerHouse, &pool, wins);
+        stopWorkerPool(&pool);
+        printResults(wins, numHouses * gamesPerHouse, config.sketch);
+    }
+    else if (branches > 0) {
+        // The game is played once up to the branch point, each branch only plays the rest
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            snprintf(hunterNames[i], MAX_STR, "Hunter %d", i + 1);
+        }
+        int wins[RESULT_COUNT] = {0};
+        int played = runBranches(&config, hunterNames, &branchPoint, branches, numProcs > 0 ? numProcs : config.placement.numCores, wins);
+        if (played > 0) {
+            printResults(wins, played, config.sketch);
+        }
+    }
+    else if (numProcs > 0) {
+        // Each worker process plays its batches on a thread of its own, the totals are merged here
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            snprintf(hunterNames[i], MAX_STR, "Hunter %d", i + 1);
+        }
+        int wins[RESULT_COUNT] = {0};
+        int played = runCoordinator(&config, hunterNames, games, numProcs, wins);
+        if (played > 0) {
+            printResults(wins, played, config.sketch);
+        }
+    }
+    else if (games <= 0) {
+        // Ask the user to input 4 names for our hunters
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            printf("Enter name for hunter %d: ", i + 1);
+            fgets(hunterNames[i], MAX_STR, stdin);
+            hunterNames[i][strcspn(hunterNames[i], "\n")] = 0;  // Remove newline character
+        }
+        if (recordPath != NULL && openRecording(recordPath, &config, hunterNames) != 0) {
+            return 1;
+        }
+        runGame(&config, hunterNames);
+        closeRecording();
     }
-    else{
-        printf("The ghost's boredom level is %d\n", ghost->boredomTime);
-        printf("The ghost got bored and left\n");
+    else {
+        // Batch runs don't stop to ask for names
+        for (int i = 0; i < NUM_HUNTERS; i++) {
+            snprintf(hunterNames[i], MAX_STR, "Hunter %d", i + 1);
+        }
+        if (recordPath != NULL && openRecording(recordPath, &config, hunterNames) != 0) {
+            return 1;
+        }
+        int wins[RESULT_COUNT] = {0};
+        if (lockstepThreads > 0) {
+            runLockstep(&config, hunterNames, games, lockstepThreads, wins);
+        }
+        else if (coopThreads > 0) {
+            WorkerPoolType pool;
+            startWorkerPool(&pool, coopThreads, &config.placement);
+            runCoopGames(&config, hunterNames, games, &pool, wins, NULL, stdout);
+            stopWorkerPool(&pool);
+        }
+        for (int i = 0; coopThreads <= 0 && lockstepThreads <= 0 && i < games; i++) {
+            config.seed = seed + i;
+            wins[runGame(&config, hunterNames)]++;
+        }
+        closeRecording();
+        printResults(wins, games, config.sketch);
     }
 
-    // Free memory
-    freeGhost(ghost);
-    freeHouse(&house);
-    free(ghostContext);
-    for (int i = 0; i < NUM_HUNTERS; i++) {
-        free(hunterContexts[i]);
+    if (config.stats != NULL) {
+        closeStats(config.stats);
+    }
+    closeResults(config.results);
+    freeHouseTemplate(config.house);
+    if (config.pacers != NULL) {
+        printPacingReport(config.pacers, hunterNames);
+        free(config.pacers);
+    }
+    // a guard build fails the run if the game loop touched the heap
+    if (checkAllocations() != 0) {
+        return 1;
     }
-    
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
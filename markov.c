@@ -0,0 +1,766 @@
+#include "defs.h"
+#include <math.h>
+
+/*
+The model solves the game the engine plays with '--party' and a '--fade' of at most MARKOV_MAX_FADE, exactly, as the
+scheduler of '--coop' and '--lockstep' plays it. The ghost and the hunters take their first turns in the same tick,
+the ghost every GHOST_WAIT / COOP_TICK ticks and the party every HUNTER_WAIT / COOP_TICK, the ghost first when both
+are due, so the ghost updates between two party turns (the gap) only depend on how many party turns have passed and
+repeat every GHOST_WAIT / COOP_TICK of them. The chain steps from one party turn to the next, the state being the
+ghost's room and boredom, the party's room and fear, how many of the ghost's evidence types are collected and the
+phase, which fixes the gap. That is the whole game:
+- the hunters share a room, fear and boredom, so they all leave on the same turn
+- hunter boredom never ends a game, the ghost's boredom only resets when it finds the party, which scares the party
+  on its next turn, so the ghost is always bored before the party
+- the ghost can't move while the party is in its room, and the party doesn't move between its turns, so once the
+  ghost finds the party it stays until the party's turn
+- evidence fades before the party's next turn, so the party only finds what the ghost left in its room since the
+  last turn, which is only ever left while the ghost is with the party
+- the ghost classes behave the same up to renaming their evidence, so only the number of types collected matters
+Every step raises the party's fear, or keeps it and raises the ghost's boredom, so putting the rows in levels by fear
+and then boredom, every row only leads to rows of higher levels. Solving the levels from the highest down gives the
+exact answer in one pass, each level's rows split over the threads, which only read rows of levels already solved.
+*/
+
+#define MARKOV_EVIDENCE_MASKS   (1 << MAX_EVIDENCE)
+#define MARKOV_MAX_OUTCOMES     4096
+#define MARKOV_VECTORS          (RESULT_COUNT + 2)
+#define MARKOV_LENGTH           RESULT_COUNT
+#define MARKOV_SQUARE           (RESULT_COUNT + 1)
+
+// one state of the party game, just after a party turn
+typedef struct MarkovState {
+    int ghostRoom;
+    int ghostBoredom;
+    int partyRoom;
+    int fear;
+    int collected;
+    int phase;
+} MarkovStateType;
+
+// next states of one row, an absorbing outcome is stored as -1 - GameResult, with the ghost updates of the step
+typedef struct MarkovOutcomes {
+    int size;
+    int target[MARKOV_MAX_OUTCOMES];
+    double prob[MARKOV_MAX_OUTCOMES];
+    double updates;
+    double squares;
+} MarkovOutcomesType;
+
+// what each solver thread needs to run its share of every level
+typedef struct MarkovWorker {
+    MarkovModelType *model;
+    int id;
+} MarkovWorkerType;
+
+/*
+Function: int encodeState(MarkovModelType *model, const MarkovStateType *state)
+Purpose: Packs a state into its position in the full, unreduced state space.
+in: model - Pointer to the MarkovModelType structure describing the house
+in: state - Pointer to the MarkovStateType to pack
+return: Returns the packed state
+*/
+static int encodeState(MarkovModelType *model, const MarkovStateType *state)
+{
+    int code = state->ghostRoom;
+    code = code * BOREDOM_MAX + state->ghostBoredom;
+    code = code * model->numRooms + state->partyRoom;
+    code = code * FEAR_MAX + state->fear;
+    code = code * (MAX_EVIDENCE + 1) + state->collected;
+    code = code * MARKOV_PHASES + state->phase;
+    return code;
+}
+
+/*
+Function: void decodeState(MarkovModelType *model, int code, MarkovStateType *state)
+Purpose: Unpacks a state packed by encodeState.
+in: model - Pointer to the MarkovModelType structure describing the house
+in: code - The packed state
+out: state - Pointer to the MarkovStateType receiving the state
+return: none
+*/
+static void decodeState(MarkovModelType *model, int code, MarkovStateType *state)
+{
+    state->phase = code % MARKOV_PHASES;
+    code /= MARKOV_PHASES;
+    state->collected = code % (MAX_EVIDENCE + 1);
+    code /= MAX_EVIDENCE + 1;
+    state->fear = code % FEAR_MAX;
+    code /= FEAR_MAX;
+    state->partyRoom = code % model->numRooms;
+    code /= model->numRooms;
+    state->ghostBoredom = code % BOREDOM_MAX;
+    state->ghostRoom = code / BOREDOM_MAX;
+}
+
+/*
+Function: int findState(MarkovModelType *model, const MarkovStateType *state)
+Purpose: Looks up the row of a state, giving it the next free row the first time it is reached.
+in/out: model - Pointer to the MarkovModelType structure, its state tables grow as states are reached
+in: state - Pointer to the MarkovStateType to look up
+return: Returns the row of the state
+*/
+static int findState(MarkovModelType *model, const MarkovStateType *state)
+{
+    int code = encodeState(model, state);
+    if (model->stateIndex[code] < 0)
+    {
+        if (model->numStates == model->stateCapacity)
+        {
+            model->stateCapacity *= 2;
+            model->stateCode = realloc(model->stateCode, model->stateCapacity * sizeof(int));
+            if (model->stateCode == NULL)
+            {
+                printf("Error allocating memory for markov states\n");
+                exit(1);
+            }
+        }
+        model->stateCode[model->numStates] = code;
+        model->stateIndex[code] = model->numStates;
+        model->numStates++;
+    }
+    return model->stateIndex[code];
+}
+
+/*
+Function: void addOutcome(MarkovOutcomesType *outcomes, int target, double prob, int updates)
+Purpose: Adds a next state to the outcomes of the row being built.
+in/out: outcomes - Pointer to the MarkovOutcomesType being filled
+in: target - Row of the next state, or -1 - GameResult for an absorbing outcome
+in: prob - Probability of the transition
+in: updates - Ghost updates the game's clock counts on the way, all of the step's unless the ghost got bored
+return: none
+*/
+static void addOutcome(MarkovOutcomesType *outcomes, int target, double prob, int updates)
+{
+    if (outcomes->size == MARKOV_MAX_OUTCOMES)
+    {
+        printf("Error: Too many transitions out of one markov state\n");
+        exit(1);
+    }
+    outcomes->target[outcomes->size] = target;
+    outcomes->prob[outcomes->size] = prob;
+    outcomes->size++;
+    outcomes->updates += prob * updates;
+    outcomes->squares += prob * updates * updates;
+}
+
+/*
+Function: int phaseGap(int turn)
+Purpose: Counts the ghost updates the scheduler takes before a party turn and after the one before it.
+in: turn - Number of party turns before this one
+return: Returns the number of ghost updates
+*/
+static int phaseGap(int turn)
+{
+    int ghostTicks = GHOST_WAIT / COOP_TICK;
+    int hunterTicks = HUNTER_WAIT / COOP_TICK;
+    // both start in the same tick and the ghost goes first, so the ghost has updated turn * hunterTicks / ghostTicks + 1 times
+    if (turn == 0)
+    {
+        return 1;
+    }
+    return turn * hunterTicks / ghostTicks - (turn - 1) * hunterTicks / ghostTicks;
+}
+
+/*
+Function: void partyTurn(MarkovModelType *model, const MarkovStateType *state, const double searched[], double prob, int updates, MarkovOutcomesType *outcomes)
+Purpose: Adds the outcomes of the party's turn, mirroring updatePartyState.
+in/out: model - Pointer to the MarkovModelType structure
+in: state - Pointer to the state after the ghost's updates, already in the next phase
+in: searched - Array of MAX_EVIDENCE + 1 chances of the party holding each number of the ghost's types if it searches
+in: prob - Probability of reaching this state
+in: updates - Ghost updates of the step
+in/out: outcomes - Pointer to the MarkovOutcomesType being filled
+return: none
+*/
+static void partyTurn(MarkovModelType *model, const MarkovStateType *state, const double searched[], double prob, int updates, MarkovOutcomesType *outcomes)
+{
+    MarkovStateType next = *state;
+    if (next.ghostRoom == next.partyRoom)
+    {
+        next.fear++;
+        if (next.fear >= FEAR_MAX)
+        {
+            addOutcome(outcomes, -1 - RESULT_GHOST_WINS, prob, updates);
+            return;
+        }
+    }
+
+    // the whole party moves to a random connected room
+    int degree = model->degree[next.partyRoom];
+    for (int i = 0; i < degree; i++)
+    {
+        MarkovStateType moved = next;
+        moved.partyRoom = model->neighbours[next.partyRoom][i];
+        addOutcome(outcomes, findState(model, &moved), prob / (3 * degree), updates);
+    }
+
+    // every hunter searches with its own equipment, which between them covers every type the ghost leaves
+    for (int collected = next.collected; collected <= MAX_EVIDENCE; collected++)
+    {
+        if (searched[collected] > 0)
+        {
+            MarkovStateType found = next;
+            found.collected = collected;
+            addOutcome(outcomes, findState(model, &found), prob * searched[collected] / 3, updates);
+        }
+    }
+
+    // review the evidence, which always names the ghost once all three of its types are in
+    if (next.collected == MAX_EVIDENCE)
+    {
+        addOutcome(outcomes, -1 - RESULT_HUNTERS_WIN, prob / 3, updates);
+    }
+    else
+    {
+        addOutcome(outcomes, findState(model, &next), prob / 3, updates);
+    }
+}
+
+/*
+Function: void buildRow(MarkovModelType *model, int row, MarkovOutcomesType *outcomes)
+Purpose: Adds the outcomes of one step from a state: the ghost's updates of the phase, then the party's turn.
+in/out: model - Pointer to the MarkovModelType structure
+in: row - Row of the state
+out: outcomes - Pointer to the MarkovOutcomesType being filled
+return: none
+*/
+static void buildRow(MarkovModelType *model, int row, MarkovOutcomesType *outcomes)
+{
+    MarkovStateType state;
+    decodeState(model, model->stateCode[row], &state);
+    outcomes->size = 0;
+    outcomes->updates = 0;
+    outcomes->squares = 0;
+
+    int gap = model->gap[state.phase];
+    int table = (state.phase * model->numRooms + state.partyRoom) * model->numRooms + state.ghostRoom;
+    const double *meet = &model->meet[table * MARKOV_MAX_GAP];
+    const double *walk = &model->walk[table * model->numRooms];
+    // the ghost gets bored on its update number left - 1 unless it finds the party first
+    int left = BOREDOM_MAX - state.ghostBoredom;
+    double boredProb = 0;
+
+    MarkovStateType next = state;
+    next.phase = state.phase == MARKOV_PHASES - 1 ? 1 : state.phase + 1;
+
+    // once the ghost finds the party it stays for the rest of the phase, so the evidence it leaves is in the party's
+    // room, and what was left on the updates from firstVisible on hasn't faded by the party's turn. Wherever in the
+    // phase it found the party the next state is the same but for what a search turns up, so they share one turn.
+    int firstVisible = gap - (int)model->fadeTime + 1;
+    int held = (1 << state.collected) - 1;
+    double meetProb = 0;
+    double searched[MAX_EVIDENCE + 1] = { 0 };
+    for (int found = 0; found < gap; found++)
+    {
+        if (meet[found] == 0)
+        {
+            continue;
+        }
+        if (found >= left)
+        {
+            boredProb += meet[found];
+            continue;
+        }
+        int window = gap - (found > firstVisible ? found : firstVisible);
+        meetProb += meet[found];
+        for (int mask = 0; mask < MARKOV_EVIDENCE_MASKS; mask++)
+        {
+            searched[__builtin_popcount(held | mask)] += meet[found] * model->evidenceOdds[window][mask];
+        }
+    }
+    if (meetProb > 0)
+    {
+        for (int collected = 0; collected <= MAX_EVIDENCE; collected++)
+        {
+            searched[collected] /= meetProb;
+        }
+        next.ghostRoom = state.partyRoom;
+        next.ghostBoredom = 0;
+        partyTurn(model, &next, searched, meetProb, gap, outcomes);
+    }
+
+    // a ghost that only walked into the party's room on its last update hasn't left any evidence there
+    double nothing[MAX_EVIDENCE + 1] = { 0 };
+    nothing[state.collected] = 1;
+    for (int room = 0; room < model->numRooms; room++)
+    {
+        if (walk[room] == 0)
+        {
+            continue;
+        }
+        if (gap >= left)
+        {
+            boredProb += walk[room];
+            continue;
+        }
+        next.ghostRoom = room;
+        next.ghostBoredom = state.ghostBoredom + gap;
+        partyTurn(model, &next, nothing, walk[room], gap, outcomes);
+    }
+    if (boredProb > 0)
+    {
+        // the game is scored with the evidence the party has, which is enough for it to win once it has all three
+        addOutcome(outcomes, state.collected == MAX_EVIDENCE ? -1 - RESULT_HUNTERS_WIN : -1 - RESULT_GHOST_BORED, boredProb, left - 1);
+    }
+}
+
+/*
+Function: void walkGhost(MarkovModelType *model, int phase, int partyRoom, int ghostRoom)
+Purpose: Fills the meet and walk tables of a phase for the ghost starting away from a party that stays put, mirroring
+         updateGhostState: away from the hunters it does nothing, leaves evidence or moves to a random connected room.
+in/out: model - Pointer to the MarkovModelType structure
+in: phase - The phase
+in: partyRoom - The party's room
+in: ghostRoom - The ghost's room at the start of the phase
+return: none
+*/
+static void walkGhost(MarkovModelType *model, int phase, int partyRoom, int ghostRoom)
+{
+    int table = (phase * model->numRooms + partyRoom) * model->numRooms + ghostRoom;
+    double *meet = &model->meet[table * MARKOV_MAX_GAP];
+    double *walk = &model->walk[table * model->numRooms];
+    double odds[MAX_ROOMS] = { 0 };
+    double moved[MAX_ROOMS];
+    odds[ghostRoom] = 1;
+    for (int update = 0; update < model->gap[phase]; update++)
+    {
+        meet[update] = odds[partyRoom];
+        odds[partyRoom] = 0;
+        memset(moved, 0, sizeof(moved));
+        for (int room = 0; room < model->numRooms; room++)
+        {
+            int degree = model->degree[room];
+            moved[room] += degree > 0 ? odds[room] * 2 / 3 : odds[room];
+            for (int i = 0; i < degree; i++)
+            {
+                moved[model->neighbours[room][i]] += odds[room] / (3 * degree);
+            }
+        }
+        memcpy(odds, moved, sizeof(odds));
+    }
+    memcpy(walk, odds, model->numRooms * sizeof(double));
+}
+
+/*
+Function: void initMarkovModel(MarkovModelType *model, HouseType *house, long fadeTime)
+Purpose: Copies the room connections of a house into the model and works out how the ghost moves and leaves evidence
+         between two party turns.
+in/out: model - Pointer to the MarkovModelType structure to be initialized
+in: house - Pointer to the HouseType structure, its rooms must be numbered
+in: fadeTime - Ghost updates a piece of evidence lasts, from 1 to MARKOV_MAX_FADE
+return: none
+*/
+void initMarkovModel(MarkovModelType *model, HouseType *house, long fadeTime)
+{
+    memset(model, 0, sizeof(MarkovModelType));
+    for (RoomNodeType *current = house->rooms->rhead; current != NULL; current = current->next)
+    {
+        RoomType *room = current->room;
+        if (room->id < 0 || room->id >= MAX_ROOMS)
+        {
+            printf("Error: House is too big for the exact solver\n");
+            exit(1);
+        }
+        model->numRooms++;
+        if (room->roomlist == NULL)
+        {
+            continue;
+        }
+        for (RoomNodeType *connected = room->roomlist->rhead; connected != NULL; connected = connected->next)
+        {
+            model->neighbours[room->id][model->degree[room->id]++] = connected->room->id;
+        }
+    }
+
+    // evidence lasting longer than the shortest gap could still be found on the party's next turn
+    if (fadeTime < 1 || fadeTime > MARKOV_MAX_FADE)
+    {
+        printf("Error: The exact solver needs a --fade from 1 to %d\n", MARKOV_MAX_FADE);
+        exit(1);
+    }
+    model->fadeTime = fadeTime;
+    for (int phase = 0; phase < MARKOV_PHASES; phase++)
+    {
+        model->gap[phase] = phaseGap(phase);
+    }
+
+    int tables = MARKOV_PHASES * model->numRooms * model->numRooms;
+    model->meet = calloc((long)tables * MARKOV_MAX_GAP, sizeof(double));
+    model->walk = calloc((long)tables * model->numRooms, sizeof(double));
+    if (model->meet == NULL || model->walk == NULL)
+    {
+        printf("Error allocating memory for markov model\n");
+        exit(1);
+    }
+    for (int phase = 0; phase < MARKOV_PHASES; phase++)
+    {
+        for (int partyRoom = 0; partyRoom < model->numRooms; partyRoom++)
+        {
+            for (int ghostRoom = 0; ghostRoom < model->numRooms; ghostRoom++)
+            {
+                walkGhost(model, phase, partyRoom, ghostRoom);
+            }
+        }
+    }
+
+    // on each update with the party the ghost does nothing, leaves one of its three types or tries to move and can't
+    model->evidenceOdds[0][0] = 1;
+    for (int updates = 1; updates <= MARKOV_MAX_GAP; updates++)
+    {
+        for (int mask = 0; mask < MARKOV_EVIDENCE_MASKS; mask++)
+        {
+            double odds = model->evidenceOdds[updates - 1][mask];
+            model->evidenceOdds[updates][mask] += odds * 2 / 3;
+            for (int i = 0; i < MAX_EVIDENCE; i++)
+            {
+                model->evidenceOdds[updates][mask | 1 << i] += odds / (3 * MAX_EVIDENCE);
+            }
+        }
+    }
+}
+
+/*
+Function: void orderLevels(MarkovModelType *model)
+Purpose: Sorts the rows into the order they are solved in, the highest level first, a row's level being the party's
+         fear and then the ghost's boredom. Checks every transition leads to a higher level, which is what lets
+         each level be solved in one go.
+in/out: model - Pointer to the MarkovModelType structure, with its transitions built
+return: none
+*/
+static void orderLevels(MarkovModelType *model)
+{
+    SparseMatrixType *matrix = &model->transitions;
+    int rows = matrix->rows;
+    model->numLevels = FEAR_MAX * BOREDOM_MAX;
+    int *level = malloc(rows * sizeof(int));
+    model->order = malloc(rows * sizeof(int));
+    model->levelStart = calloc(model->numLevels + 1, sizeof(int));
+    if (level == NULL || model->order == NULL || model->levelStart == NULL)
+    {
+        printf("Error allocating memory for markov levels\n");
+        exit(1);
+    }
+
+    // levels are numbered in solving order, so the highest fear and boredom is level 0
+    for (int row = 0; row < rows; row++)
+    {
+        MarkovStateType state;
+        decodeState(model, model->stateCode[row], &state);
+        level[row] = model->numLevels - 1 - (state.fear * BOREDOM_MAX + state.ghostBoredom);
+        model->levelStart[level[row] + 1]++;
+    }
+    for (int i = 0; i < model->numLevels; i++)
+    {
+        model->levelStart[i + 1] += model->levelStart[i];
+    }
+    int *next = malloc(model->numLevels * sizeof(int));
+    if (next == NULL)
+    {
+        printf("Error allocating memory for markov levels\n");
+        exit(1);
+    }
+    memcpy(next, model->levelStart, model->numLevels * sizeof(int));
+    for (int row = 0; row < rows; row++)
+    {
+        model->order[next[level[row]]++] = row;
+        for (int j = matrix->rowStart[row]; j < matrix->rowStart[row + 1]; j++)
+        {
+            if (level[matrix->column[j]] >= level[row])
+            {
+                printf("Error: Markov state %d leads back to a level not above its own\n", row);
+                exit(1);
+            }
+        }
+    }
+    free(next);
+    free(level);
+}
+
+/*
+Function: void buildMarkovModel(MarkovModelType *model)
+Purpose: Builds the sparse transition matrix over every state reachable from the start of a game.
+in/out: model - Pointer to the MarkovModelType structure, initialized with initMarkovModel
+return: none
+*/
+void buildMarkovModel(MarkovModelType *model)
+{
+    int fullSize = model->numRooms * BOREDOM_MAX * model->numRooms * FEAR_MAX * (MAX_EVIDENCE + 1) * MARKOV_PHASES;
+    model->stateIndex = malloc(fullSize * sizeof(int));
+    model->stateCapacity = 1024;
+    model->stateCode = malloc(model->stateCapacity * sizeof(int));
+    if (model->stateIndex == NULL || model->stateCode == NULL)
+    {
+        printf("Error allocating memory for markov states\n");
+        exit(1);
+    }
+    memset(model->stateIndex, -1, fullSize * sizeof(int));
+
+    // the ghost starts in a room picked by getRandomRoomExcludeVan and the party in the Van (room 0),
+    // getRandomRoomExcludeVan never returns the last room, so neither does the model
+    model->numStarts = model->numRooms - 2;
+    for (int room = 1; room <= model->numStarts; room++)
+    {
+        MarkovStateType start = { room, 0, 0, 0, 0, 0 };
+        findState(model, &start);
+    }
+
+    // rows are built in the order states are reached, which keeps the matrix in CSR order
+    int capacity = 1024;
+    SparseMatrixType *matrix = &model->transitions;
+    matrix->rowStart = NULL;
+    matrix->column = malloc(capacity * sizeof(int));
+    matrix->value = malloc(capacity * sizeof(double));
+    model->rowGap = NULL;
+    model->updates = NULL;
+    model->squares = NULL;
+    for (int i = 0; i < RESULT_COUNT; i++)
+    {
+        model->absorb[i] = NULL;
+    }
+
+    MarkovOutcomesType *outcomes = malloc(sizeof(MarkovOutcomesType));
+    // position of each target in the merged row, so repeated targets are summed rather than stored twice
+    int rowCapacity = 0;
+    int *slot = NULL;
+
+    int nonZeros = 0;
+    int row = 0;
+    for (; row < model->numStates; row++)
+    {
+        buildRow(model, row, outcomes);
+
+        // the per row arrays grow with the state tables
+        if (model->stateCapacity > rowCapacity)
+        {
+            slot = realloc(slot, model->stateCapacity * sizeof(int));
+            matrix->rowStart = realloc(matrix->rowStart, (model->stateCapacity + 1) * sizeof(int));
+            model->rowGap = realloc(model->rowGap, model->stateCapacity * sizeof(int));
+            model->updates = realloc(model->updates, model->stateCapacity * sizeof(double));
+            model->squares = realloc(model->squares, model->stateCapacity * sizeof(double));
+            for (int i = 0; i < RESULT_COUNT; i++)
+            {
+                model->absorb[i] = realloc(model->absorb[i], model->stateCapacity * sizeof(double));
+                if (model->absorb[i] == NULL)
+                {
+                    printf("Error allocating memory for markov matrix\n");
+                    exit(1);
+                }
+            }
+            if (matrix->rowStart == NULL || model->rowGap == NULL || model->updates == NULL || model->squares == NULL || slot == NULL)
+            {
+                printf("Error allocating memory for markov matrix\n");
+                exit(1);
+            }
+            memset(slot + rowCapacity, -1, (model->stateCapacity - rowCapacity) * sizeof(int));
+            rowCapacity = model->stateCapacity;
+        }
+        for (int i = 0; i < RESULT_COUNT; i++)
+        {
+            model->absorb[i][row] = 0;
+        }
+
+        MarkovStateType state;
+        decodeState(model, model->stateCode[row], &state);
+        matrix->rowStart[row] = nonZeros;
+        model->rowGap[row] = model->gap[state.phase];
+        model->updates[row] = outcomes->updates;
+        model->squares[row] = outcomes->squares;
+        for (int i = 0; i < outcomes->size; i++)
+        {
+            int target = outcomes->target[i];
+            double prob = outcomes->prob[i];
+            if (target < 0)
+            {
+                model->absorb[-1 - target][row] += prob;
+            }
+            else if (slot[target] >= 0)
+            {
+                matrix->value[slot[target]] += prob;
+            }
+            else
+            {
+                if (nonZeros == capacity)
+                {
+                    capacity *= 2;
+                    matrix->column = realloc(matrix->column, capacity * sizeof(int));
+                    matrix->value = realloc(matrix->value, capacity * sizeof(double));
+                    if (matrix->column == NULL || matrix->value == NULL)
+                    {
+                        printf("Error allocating memory for markov matrix\n");
+                        exit(1);
+                    }
+                }
+                slot[target] = nonZeros;
+                matrix->column[nonZeros] = target;
+                matrix->value[nonZeros] = prob;
+                nonZeros++;
+            }
+        }
+        for (int i = matrix->rowStart[row]; i < nonZeros; i++)
+        {
+            slot[matrix->column[i]] = -1;
+        }
+    }
+    matrix->rowStart[row] = nonZeros;
+    matrix->rows = model->numStates;
+    matrix->nonZeros = nonZeros;
+    orderLevels(model);
+
+    free(slot);
+    free(outcomes);
+    free(model->stateIndex);
+    model->stateIndex = NULL;
+}
+
+/*
+Function: void *markovWorker(void *param)
+Purpose: Solves the rows of every level that fall to one thread, waiting for the others at the end of each level.
+in/out: param - Pointer to the MarkovWorkerType describing the thread
+return: none
+*/
+static void *markovWorker(void *param)
+{
+    MarkovWorkerType *worker = (MarkovWorkerType *)param;
+    MarkovModelType *model = worker->model;
+    SparseMatrixType *matrix = &model->transitions;
+    double *solution = model->solution;
+
+    for (int level = 0; level < model->numLevels; level++)
+    {
+        // the level's rows only read rows of earlier levels, which no thread writes any more, so the answer doesn't
+        // depend on the number of threads or on which of them gets ahead
+        int first = model->levelStart[level];
+        int size = model->levelStart[level + 1] - first;
+        if (size == 0)
+        {
+            continue;
+        }
+        int last = first + (int)((long)size * (worker->id + 1) / model->numWorkers);
+        for (int i = first + (int)((long)size * worker->id / model->numWorkers); i < last; i++)
+        {
+            int row = model->order[i];
+            double sum[MARKOV_VECTORS];
+            for (int k = 0; k < RESULT_COUNT; k++)
+            {
+                sum[k] = model->absorb[k][row];
+            }
+            // the length gains the step's ghost updates, its square gains (gap + rest)^2 = gap^2 + 2 gap rest + rest^2
+            sum[MARKOV_LENGTH] = model->updates[row];
+            sum[MARKOV_SQUARE] = model->squares[row];
+            double twoGaps = 2.0 * model->rowGap[row];
+
+            for (int j = matrix->rowStart[row]; j < matrix->rowStart[row + 1]; j++)
+            {
+                const double *target = &solution[(long)matrix->column[j] * MARKOV_VECTORS];
+                double value = matrix->value[j];
+                for (int k = 0; k <= MARKOV_LENGTH; k++)
+                {
+                    sum[k] += value * target[k];
+                }
+                sum[MARKOV_SQUARE] += value * (twoGaps * target[MARKOV_LENGTH] + target[MARKOV_SQUARE]);
+            }
+            memcpy(&solution[(long)row * MARKOV_VECTORS], sum, sizeof(sum));
+        }
+        pthread_barrier_wait(&model->barrier);
+    }
+    return NULL;
+}
+
+/*
+Function: void solveMarkovModel(MarkovModelType *model, int numThreads, double winProb[], double *expectedLength, double *lengthDeviation)
+Purpose: Solves the absorption probabilities and the mean and spread of the game length, splitting each level's rows
+         over several threads. The answer is the same for any number of threads.
+in/out: model - Pointer to the MarkovModelType structure, built with buildMarkovModel
+in: numThreads - Number of solver threads to use
+out: winProb - Array of RESULT_COUNT probabilities of each way the game can end
+out: expectedLength - Expected number of ghost updates in a game
+out: lengthDeviation - Standard deviation of the number of ghost updates in a game
+return: none
+*/
+void solveMarkovModel(MarkovModelType *model, int numThreads, double winProb[], double *expectedLength, double *lengthDeviation)
+{
+    if (numThreads < 1)
+    {
+        numThreads = 1;
+    }
+
+    // the vectors are interleaved per row so one pass over a row's columns updates all of them
+    model->solution = calloc((long)model->transitions.rows * MARKOV_VECTORS, sizeof(double));
+    if (model->solution == NULL)
+    {
+        printf("Error allocating memory for markov solution\n");
+        exit(1);
+    }
+    model->numWorkers = numThreads;
+    pthread_barrier_init(&model->barrier, NULL, numThreads);
+
+    pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+    MarkovWorkerType *workers = malloc(numThreads * sizeof(MarkovWorkerType));
+    for (int i = 0; i < numThreads; i++)
+    {
+        workers[i].model = model;
+        workers[i].id = i;
+    }
+    for (int i = 1; i < numThreads; i++)
+    {
+        pthread_create(&threads[i], NULL, markovWorker, &workers[i]);
+    }
+    markovWorker(&workers[0]);
+    for (int i = 1; i < numThreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&model->barrier);
+
+    // the start states are the first rows, each equally likely
+    for (int i = 0; i < RESULT_COUNT; i++)
+    {
+        winProb[i] = 0;
+    }
+    *expectedLength = 0;
+    double meanSquare = 0;
+    for (int start = 0; start < model->numStarts; start++)
+    {
+        const double *solved = &model->solution[(long)start * MARKOV_VECTORS];
+        for (int i = 0; i < RESULT_COUNT; i++)
+        {
+            winProb[i] += solved[i] / model->numStarts;
+        }
+        *expectedLength += solved[MARKOV_LENGTH] / model->numStarts;
+        meanSquare += solved[MARKOV_SQUARE] / model->numStarts;
+    }
+    double variance = meanSquare - *expectedLength * *expectedLength;
+    *lengthDeviation = sqrt(variance > 0 ? variance : 0);
+
+    free(threads);
+    free(workers);
+}
+
+/*
+Function: void freeMarkovModel(MarkovModelType *model)
+Purpose: Frees the memory held by a MarkovModelType structure.
+in/out: model - Pointer to the MarkovModelType structure to be freed
+return: none
+*/
+void freeMarkovModel(MarkovModelType *model)
+{
+    free(model->meet);
+    free(model->walk);
+    free(model->stateIndex);
+    free(model->stateCode);
+    free(model->transitions.rowStart);
+    free(model->transitions.column);
+    free(model->transitions.value);
+    for (int i = 0; i < RESULT_COUNT; i++)
+    {
+        free(model->absorb[i]);
+    }
+    free(model->rowGap);
+    free(model->updates);
+    free(model->squares);
+    free(model->order);
+    free(model->levelStart);
+    free(model->solution);
+}
@@ -0,0 +1,147 @@
+#include "defs.h"
+
+/*
+Function: void initPacer(PacerType *pacer, long spinTime)
+Purpose: Initializes an agent's pacer with an empty lateness histogram.
+in/out: pacer - Pointer to the PacerType structure to be initialized
+in: spinTime - Microseconds before each deadline spent spinning instead of sleeping, 0 to only sleep
+return: none
+*/
+void initPacer(PacerType *pacer, long spinTime)
+{
+    memset(pacer, 0, sizeof(PacerType));
+    pacer->spin = spinTime * 1000;
+}
+
+/*
+Function: void startPacer(PacerType *pacer)
+Purpose: Starts an agent's deadlines from now, at the start of each game.
+in/out: pacer - Pointer to the agent's PacerType structure, NULL if the agent isn't paced
+return: none
+*/
+void startPacer(PacerType *pacer)
+{
+    if (pacer != NULL)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &pacer->deadline);
+    }
+}
+
+/*
+Function: void addNanoseconds(struct timespec *time, long nanoseconds)
+Purpose: Moves a time on by a number of nanoseconds.
+in/out: time - Pointer to the time to move on
+in: nanoseconds - Nanoseconds to add, less than a second
+return: none
+*/
+static void addNanoseconds(struct timespec *time, long nanoseconds)
+{
+    time->tv_nsec += nanoseconds;
+    if (time->tv_nsec >= 1000000000L)
+    {
+        time->tv_nsec -= 1000000000L;
+        time->tv_sec++;
+    }
+    else if (time->tv_nsec < 0)
+    {
+        time->tv_nsec += 1000000000L;
+        time->tv_sec--;
+    }
+}
+
+/*
+Function: long nanosecondsBetween(struct timespec *from, struct timespec *to)
+Purpose: Works out how far one time is after another.
+in: from - Pointer to the earlier time
+in: to - Pointer to the later time
+return: Returns the nanoseconds from from to to, negative if to is earlier
+*/
+static long nanosecondsBetween(struct timespec *from, struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) * 1000000000L + (to->tv_nsec - from->tv_nsec);
+}
+
+/*
+Function: void waitTurn(PacerType *pacer, long wait)
+Purpose: Waits until an agent's next turn. Without a pacer this sleeps for wait microseconds after the turn, with one
+         the turn is due wait microseconds after the last deadline, so the time spent on turns doesn't add up.
+in/out: pacer - Pointer to the agent's PacerType structure, NULL to just sleep
+in: wait - Microseconds between turns
+return: none
+*/
+void waitTurn(PacerType *pacer, long wait)
+{
+    if (pacer == NULL)
+    {
+        usleep(wait);
+        return;
+    }
+
+    addNanoseconds(&pacer->deadline, wait * 1000);
+    struct timespec wake = pacer->deadline;
+    if (pacer->spin > 0)
+    {
+        // sleeping wakes up late by the scheduler's latency, so the last stretch is spun instead
+        addNanoseconds(&wake, -(pacer->spin < wait * 1000 ? pacer->spin : wait * 1000));
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) != 0)
+    {
+        // interrupted by a signal, the deadline hasn't moved
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    while (pacer->spin > 0 && nanosecondsBetween(&pacer->deadline, &now) < 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+
+    long lateness = nanosecondsBetween(&pacer->deadline, &now);
+    lateness = lateness > 0 ? lateness : 0;
+    pacer->maxLateness = lateness > pacer->maxLateness ? lateness : pacer->maxLateness;
+    pacer->lateness[lateness / 1000 < PACER_BUCKETS - 1 ? lateness / 1000 : PACER_BUCKETS - 1]++;
+    pacer->turns++;
+}
+
+/*
+Function: long latenessPercentile(PacerType *pacer, double percentile)
+Purpose: Finds the lateness below which the given share of an agent's turns started.
+in: pacer - Pointer to the agent's PacerType structure
+in: percentile - The share of turns, between 0 and 100
+return: Returns the lateness in microseconds, PACER_BUCKETS - 1 means at least that late
+*/
+static long latenessPercentile(PacerType *pacer, double percentile)
+{
+    long target = (long)(pacer->turns * percentile / 100.0);
+    long seen = 0;
+    for (int bucket = 0; bucket < PACER_BUCKETS; bucket++)
+    {
+        seen += pacer->lateness[bucket];
+        if (seen > target)
+        {
+            return bucket;
+        }
+    }
+    return PACER_BUCKETS - 1;
+}
+
+/*
+Function: void printPacingReport(PacerType pacers[], char hunterNames[][MAX_STR])
+Purpose: Prints how late each agent's turns started over every game played, as percentiles of its deadlines.
+in: pacers - Array of NUM_HUNTERS + 1 pacers, the ghost's first
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: none
+*/
+void printPacingReport(PacerType pacers[], char hunterNames[][MAX_STR])
+{
+    printf("\nLateness of turns against their deadlines (us)\n");
+    printf("=================================\n");
+    printf("%-12s %8s %8s %8s %8s %8s %8s %8s\n", "Agent", "Period", "Turns", "p50", "p90", "p99", "p99.9", "Max");
+    for (int agent = 0; agent <= NUM_HUNTERS; agent++)
+    {
+        PacerType *pacer = &pacers[agent];
+        printf("%-12s %8d %8ld %8ld %8ld %8ld %8ld %8ld\n", agent == GHOST_AGENT ? "Ghost" : hunterNames[agent - 1],
+               agent == GHOST_AGENT ? GHOST_WAIT : HUNTER_WAIT, pacer->turns, latenessPercentile(pacer, 50),
+               latenessPercentile(pacer, 90), latenessPercentile(pacer, 99), latenessPercentile(pacer, 99.9), pacer->maxLateness / 1000);
+    }
+}
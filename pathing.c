@@ -0,0 +1,337 @@
+#include "defs.h"
+
+/*
+Function: void bfsDistances(RoomIndexType *index, int source, int *distances, int *queue)
+Purpose: Finds the number of moves from one room to every other room with a breadth first search.
+in: index - Pointer to the RoomIndexType structure holding the rooms by id
+in: source - Id of the room to search from
+out: distances - Array of numRooms distances, -1 for rooms that can't be reached
+in/out: queue - Scratch array of numRooms ids
+return: none
+*/
+static void bfsDistances(RoomIndexType *index, int source, int *distances, int *queue)
+{
+    for (int i = 0; i < index->numRooms; i++)
+    {
+        distances[i] = -1;
+    }
+
+    int head = 0;
+    int tail = 0;
+    distances[source] = 0;
+    queue[tail++] = source;
+    while (head < tail)
+    {
+        RoomType *room = index->rooms[queue[head++]];
+        if (room->roomlist == NULL)
+        {
+            continue;
+        }
+        for (RoomNodeType *connected = room->roomlist->rhead; connected != NULL; connected = connected->next)
+        {
+            int next = connected->room->id;
+            if (distances[next] < 0)
+            {
+                distances[next] = distances[room->id] + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+}
+
+/*
+Function: void buildRoomIndex(HouseType *house)
+Purpose: Numbers the rooms of the house and precomputes the distances used for pathing.
+         Houses up to DISTANCE_MATRIX_MAX rooms keep every room to room distance, bigger houses keep
+         the distances to NUM_LANDMARKS landmark rooms spread across the house.
+in/out: house - Pointer to the HouseType structure, its index is filled in
+return: none
+*/
+void buildRoomIndex(HouseType *house)
+{
+    RoomIndexType *index = malloc(sizeof(RoomIndexType));
+    if (index == NULL)
+    {
+        printf("Error allocating memory for room index\n");
+        exit(1);
+    }
+
+    // Number the rooms in the order they were added, the Van is room 0
+    index->numRooms = house->rooms->size;
+    index->rooms = malloc(index->numRooms * sizeof(RoomType *));
+    int id = 0;
+    for (RoomNodeType *current = house->rooms->rhead; current != NULL; current = current->next)
+    {
+        current->room->id = id;
+        index->rooms[id] = current->room;
+        id++;
+    }
+
+    int *queue = malloc(index->numRooms * sizeof(int));
+    index->vanDistance = malloc(index->numRooms * sizeof(int));
+    if (index->rooms == NULL || queue == NULL || index->vanDistance == NULL)
+    {
+        printf("Error allocating memory for room index\n");
+        exit(1);
+    }
+    bfsDistances(index, 0, index->vanDistance, queue);
+
+    if (index->numRooms <= DISTANCE_MATRIX_MAX)
+    {
+        // one search from every room
+        index->numLandmarks = 0;
+        index->landmarkDistances = NULL;
+        index->distances = malloc((long)index->numRooms * index->numRooms * sizeof(int));
+        if (index->distances == NULL)
+        {
+            printf("Error allocating memory for room distances\n");
+            exit(1);
+        }
+        for (int room = 0; room < index->numRooms; room++)
+        {
+            bfsDistances(index, room, &index->distances[(long)room * index->numRooms], queue);
+        }
+    }
+    else
+    {
+        // landmarks are picked farthest first, starting from the Van, so they cover the house
+        index->distances = NULL;
+        index->numLandmarks = NUM_LANDMARKS;
+        index->landmarkDistances = malloc((long)NUM_LANDMARKS * index->numRooms * sizeof(int));
+        if (index->landmarkDistances == NULL)
+        {
+            printf("Error allocating memory for landmark distances\n");
+            exit(1);
+        }
+        int landmark = 0;
+        for (int i = 0; i < NUM_LANDMARKS; i++)
+        {
+            int *distances = &index->landmarkDistances[(long)i * index->numRooms];
+            bfsDistances(index, landmark, distances, queue);
+
+            int farthest = 0;
+            for (int room = 0; room < index->numRooms; room++)
+            {
+                int closest = distances[room];
+                for (int j = 0; j < i; j++)
+                {
+                    int other = index->landmarkDistances[(long)j * index->numRooms + room];
+                    closest = other < closest ? other : closest;
+                }
+                if (closest > farthest)
+                {
+                    farthest = closest;
+                    landmark = room;
+                }
+            }
+        }
+    }
+
+    free(queue);
+    house->index = index;
+}
+
+/*
+Function: int roomDistance(RoomIndexType *index, int from, int to)
+Purpose: Returns the number of moves between two rooms, exact for small houses and a landmark lower bound for big ones.
+in: index - Pointer to the RoomIndexType structure of the house
+in: from - Id of the first room
+in: to - Id of the second room
+return: Returns the distance between the rooms
+*/
+int roomDistance(RoomIndexType *index, int from, int to)
+{
+    if (index->distances != NULL)
+    {
+        return index->distances[(long)from * index->numRooms + to];
+    }
+
+    // the triangle inequality gives |d(L, a) - d(L, b)| <= d(a, b) for every landmark L
+    int bound = 0;
+    for (int i = 0; i < index->numLandmarks; i++)
+    {
+        const int *distances = &index->landmarkDistances[(long)i * index->numRooms];
+        int difference = distances[from] - distances[to];
+        difference = difference < 0 ? -difference : difference;
+        bound = difference > bound ? difference : bound;
+    }
+    return bound;
+}
+
+/*
+Function: size_t frontierSize(int numRooms)
+Purpose: Returns the bytes of a hunter's frontier block: one visited flag per room rounded out to whole cache lines,
+         followed by the marks, queue and first moves of its searches, numRooms ints each.
+in: numRooms - Number of rooms in the house
+return: Returns the size of the block, a whole number of cache lines
+*/
+size_t frontierSize(int numRooms)
+{
+    size_t flags = ((size_t)numRooms + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    size_t size = flags + 3 * (size_t)numRooms * sizeof(int);
+    return (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+/*
+Function: void visitRoom(HunterType *hunter, int room)
+Purpose: Marks a room as searched by a hunter using the frontier policy, keeping its count of unvisited rooms.
+in/out: hunter - Pointer to the HunterType structure
+in: room - Id of the room
+return: none
+*/
+void visitRoom(HunterType *hunter, int room)
+{
+    if (!hunter->visited[room])
+    {
+        hunter->visited[room] = C_TRUE;
+        hunter->unvisited--;
+    }
+}
+
+/*
+Function: RoomType *chooseFrontierRoom(RoomIndexType *index, HunterType *hunter)
+Purpose: Picks the connected room that is the first move towards the nearest room the hunter hasn't visited yet, the
+         nearest rooms all equally likely. A room counts as visited once the hunter has searched it for evidence, so
+         a hunter in a room it hasn't searched stays. A breadth first search from the hunter's room finds the nearest
+         ones, stopping after the first layer holding one, so a move costs the rooms around the hunter and not the
+         whole house. Once every room has been visited the hunter starts a new sweep of the house.
+in: index - Pointer to the RoomIndexType structure of the house
+in/out: hunter - Pointer to the HunterType structure, its visited rooms may be reset
+return: Returns a pointer to the chosen RoomType, the hunter's own room if it hasn't searched it yet
+*/
+RoomType *chooseFrontierRoom(RoomIndexType *index, HunterType *hunter)
+{
+    RoomListType *connected = hunter->room->roomlist;
+    int numRooms = index->numRooms;
+    int source = hunter->room->id;
+    if (!hunter->visited[source])
+    {
+        return hunter->room;
+    }
+    if (hunter->unvisited == 0)
+    {
+        memset(hunter->visited, 0, numRooms);
+        hunter->visited[source] = C_TRUE;
+        hunter->unvisited = numRooms - 1;
+    }
+
+    // a room is reached by this search when its mark is the search's, so the marks are only cleared when they wrap
+    size_t flags = ((size_t)numRooms + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    int *marks = (int *)(hunter->visited + flags);
+    int *queue = marks + numRooms;
+    int *first = queue + numRooms;
+    if (hunter->searchMark == INT_MAX)
+    {
+        memset(marks, 0, numRooms * sizeof(int));
+        hunter->searchMark = 0;
+    }
+    int mark = ++hunter->searchMark;
+
+    int head = 0;
+    int tail = 0;
+    marks[source] = mark;
+    queue[tail++] = source;
+    RoomType *best = NULL;
+    int targets = 0;
+    while (head < tail && targets == 0)
+    {
+        int layerEnd = tail;
+        while (head < layerEnd)
+        {
+            RoomType *room = index->rooms[queue[head++]];
+            if (room->roomlist == NULL)
+            {
+                continue;
+            }
+            for (RoomNodeType *node = room->roomlist->rhead; node != NULL; node = node->next)
+            {
+                int next = node->room->id;
+                if (marks[next] == mark)
+                {
+                    continue;
+                }
+                marks[next] = mark;
+                first[next] = room->id == source ? next : first[room->id];
+                queue[tail++] = next;
+
+                // reservoir sampling keeps each of the nearest unvisited rooms equally likely
+                if (!hunter->visited[next] && randInt(0, ++targets) == 0)
+                {
+                    best = index->rooms[first[next]];
+                }
+            }
+        }
+    }
+
+    return best != NULL ? best : connected->rhead->room;
+}
+
+/*
+Function: RoomType *chooseEvidenceRoom(RoomIndexType *index, EvidenceIndexType *evidenceIndex, HunterType *hunter, long now)
+Purpose: Picks the connected room that is closest to a room holding the evidence the hunter's equipment finds,
+         breaking ties randomly. The rooms come from the house's evidence index, at most TRACKER_TARGETS of them.
+in: index - Pointer to the RoomIndexType structure of the house
+in: evidenceIndex - Pointer to the EvidenceIndexType structure of the house
+in: hunter - Pointer to the HunterType structure
+in: now - The current virtual time in ghost updates
+return: Returns the hunter's own room if it holds the evidence, NULL if no room does
+*/
+RoomType *chooseEvidenceRoom(RoomIndexType *index, EvidenceIndexType *evidenceIndex, HunterType *hunter, long now)
+{
+    int targets[TRACKER_TARGETS];
+    int numTargets = findRoomsWithEvidence(evidenceIndex, hunter->equipment, targets, TRACKER_TARGETS, now);
+    RoomType *best = NULL;
+    int bestDistance = 0;
+    int ties = 0;
+    for (int i = 0; i < numTargets; i++)
+    {
+        if (targets[i] == hunter->room->id)
+        {
+            return hunter->room;
+        }
+    }
+    for (RoomNodeType *node = hunter->room->roomlist->rhead; numTargets > 0 && node != NULL; node = node->next)
+    {
+        int distance = -1;
+        for (int i = 0; i < numTargets; i++)
+        {
+            int candidate = roomDistance(index, node->room->id, targets[i]);
+            if (distance < 0 || candidate < distance)
+            {
+                distance = candidate;
+            }
+        }
+
+        // reservoir sampling keeps each of the tied rooms equally likely
+        if (best == NULL || distance < bestDistance)
+        {
+            best = node->room;
+            bestDistance = distance;
+            ties = 1;
+        }
+        else if (distance == bestDistance && randInt(0, ++ties) == 0)
+        {
+            best = node->room;
+        }
+    }
+    return best;
+}
+
+/*
+Function: void freeRoomIndex(RoomIndexType *index)
+Purpose: Frees the memory held by the room index.
+in/out: index - Pointer to the RoomIndexType structure to be freed
+return: none
+*/
+void freeRoomIndex(RoomIndexType *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+    free(index->rooms);
+    free(index->vanDistance);
+    free(index->distances);
+    free(index->landmarkDistances);
+    free(index);
+}
@@ -0,0 +1,291 @@
+#include "defs.h"
+
+/*
+A recording is a header followed by a stream of records, each starting with a one byte tag:
+- an agent id (GHOST_AGENT, or 1 to NUM_HUNTERS for the hunters): one turn of that agent, followed by a
+  one byte count and the raw rand_r values it drew
+- REPLAY_DRAW: one raw rand_r value drawn outside a turn, while a game is being set up
+- REPLAY_END_GAME: the end of a game
+Recording makes every turn atomic, so the order of the turns and the values they drew are all a replay needs.
+*/
+
+#define REPLAY_MAGIC        0x31434552
+#define REPLAY_DRAW         0xFD
+#define REPLAY_END_GAME     0xFE
+#define MAX_STEP_DRAWS      255
+
+// what was recorded at the start of the file, so the replay builds the same games
+typedef struct ReplayHeader {
+    int magic;
+    int numRooms;
+    int hunterPolicy;
+    long fadeTime;
+    char hunterNames[NUM_HUNTERS][MAX_STR];
+} ReplayHeaderType;
+
+// the recording or replay in progress, random numbers have no context to carry it so it is kept here
+static struct {
+    FILE *file;
+    int replaying;
+    sem_t stepLock;
+    // the turn being recorded or replayed
+    int stepAgent;
+    int numDraws;
+    int nextDraw;
+    int draws[MAX_STEP_DRAWS];
+} recorder = { .file = NULL, .replaying = C_FALSE, .stepAgent = -1 };
+
+/*
+Function: int openRecording(const char *path, SimConfigType *config, char hunterNames[][MAX_STR])
+Purpose: Starts recording every turn and random draw of the games that follow.
+in: path - Path of the recording file to create
+in: config - Pointer to the SimConfigType structure the games are played with
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: Returns 0 on success, -1 if the file can't be created
+*/
+int openRecording(const char *path, SimConfigType *config, char hunterNames[][MAX_STR])
+{
+    recorder.file = fopen(path, "wb");
+    if (recorder.file == NULL)
+    {
+        printf("Error: Failed to create recording %s\n", path);
+        return -1;
+    }
+
+    ReplayHeaderType header;
+    memset(&header, 0, sizeof(header));
+    header.magic = REPLAY_MAGIC;
+    header.numRooms = config->numRooms;
+    header.hunterPolicy = config->hunterPolicy;
+    header.fadeTime = config->fadeTime;
+    memcpy(header.hunterNames, hunterNames, sizeof(header.hunterNames));
+    fwrite(&header, sizeof(header), 1, recorder.file);
+    sem_init(&recorder.stepLock, 0, 1);
+    recorder.replaying = C_FALSE;
+    return 0;
+}
+
+/*
+Function: int openReplay(const char *path, SimConfigType *config, char hunterNames[][MAX_STR])
+Purpose: Starts replaying a recording, restoring the options and hunter names it was made with.
+in: path - Path of the recording file
+out: config - Pointer to the SimConfigType structure receiving the recorded options
+out: hunterNames - Array of NUM_HUNTERS hunter names receiving the recorded names
+return: Returns 0 on success, -1 if the file can't be read
+*/
+int openReplay(const char *path, SimConfigType *config, char hunterNames[][MAX_STR])
+{
+    recorder.file = fopen(path, "rb");
+    if (recorder.file == NULL)
+    {
+        printf("Error: Failed to open recording %s\n", path);
+        return -1;
+    }
+
+    ReplayHeaderType header;
+    if (fread(&header, sizeof(header), 1, recorder.file) != 1 || header.magic != REPLAY_MAGIC)
+    {
+        printf("Error: %s is not a recording\n", path);
+        fclose(recorder.file);
+        recorder.file = NULL;
+        return -1;
+    }
+    config->numRooms = header.numRooms;
+    config->hunterPolicy = header.hunterPolicy;
+    config->fadeTime = header.fadeTime;
+    memcpy(hunterNames, header.hunterNames, sizeof(header.hunterNames));
+    recorder.replaying = C_TRUE;
+    return 0;
+}
+
+/*
+Function: void closeRecording()
+Purpose: Finishes the recording or replay in progress.
+return: none
+*/
+void closeRecording()
+{
+    if (recorder.file != NULL)
+    {
+        if (!recorder.replaying)
+        {
+            sem_destroy(&recorder.stepLock);
+        }
+        fclose(recorder.file);
+        recorder.file = NULL;
+    }
+    recorder.replaying = C_FALSE;
+}
+
+/*
+Function: int isReplaying()
+Purpose: Tells the game whether to run its turns from a recording instead of threads.
+return: Returns C_TRUE while replaying
+*/
+int isReplaying()
+{
+    return recorder.replaying;
+}
+
+/*
+Function: int moreReplayGames()
+Purpose: Checks if the recording holds another game.
+return: Returns C_TRUE if another game follows
+*/
+int moreReplayGames()
+{
+    int tag = fgetc(recorder.file);
+    if (tag == EOF)
+    {
+        return C_FALSE;
+    }
+    ungetc(tag, recorder.file);
+    return C_TRUE;
+}
+
+/*
+Function: int recordRandom(int value)
+Purpose: Records a raw random value when recording, or swaps in the recorded one when replaying.
+in: value - The value just drawn from rand_r
+return: Returns the value the caller should use
+*/
+int recordRandom(int value)
+{
+    if (recorder.file == NULL)
+    {
+        return value;
+    }
+
+    if (recorder.replaying)
+    {
+        if (recorder.stepAgent >= 0)
+        {
+            if (recorder.nextDraw >= recorder.numDraws)
+            {
+                printf("Error: Replay diverged, agent %d drew more random numbers than recorded\n", recorder.stepAgent);
+                exit(1);
+            }
+            return recorder.draws[recorder.nextDraw++];
+        }
+        if (fgetc(recorder.file) != REPLAY_DRAW || fread(&value, sizeof(int), 1, recorder.file) != 1)
+        {
+            printf("Error: Replay diverged while setting up a game\n");
+            exit(1);
+        }
+        return value;
+    }
+
+    // turns are written once they finish, set up draws straight away
+    if (recorder.stepAgent >= 0)
+    {
+        if (recorder.numDraws == MAX_STEP_DRAWS)
+        {
+            printf("Error: Too many random numbers drawn in one turn\n");
+            exit(1);
+        }
+        recorder.draws[recorder.numDraws++] = value;
+    }
+    else
+    {
+        fputc(REPLAY_DRAW, recorder.file);
+        fwrite(&value, sizeof(int), 1, recorder.file);
+    }
+    return value;
+}
+
+/*
+Function: void beginStep(int agent)
+Purpose: Starts a turn of an agent, when recording no other agent can take a turn until endStep.
+in: agent - GHOST_AGENT or the hunter's id
+return: none
+*/
+void beginStep(int agent)
+{
+    if (recorder.file == NULL || recorder.replaying)
+    {
+        return;
+    }
+    sem_wait(&recorder.stepLock);
+    recorder.stepAgent = agent;
+    recorder.numDraws = 0;
+}
+
+/*
+Function: void endStep()
+Purpose: Finishes a turn started by beginStep, writing it to the recording.
+return: none
+*/
+void endStep()
+{
+    if (recorder.file == NULL || recorder.replaying)
+    {
+        return;
+    }
+    fputc(recorder.stepAgent, recorder.file);
+    fputc(recorder.numDraws, recorder.file);
+    fwrite(recorder.draws, sizeof(int), recorder.numDraws, recorder.file);
+    recorder.stepAgent = -1;
+    sem_post(&recorder.stepLock);
+}
+
+/*
+Function: void endGameRecord()
+Purpose: Marks the end of a game in the recording.
+return: none
+*/
+void endGameRecord()
+{
+    if (recorder.file != NULL && !recorder.replaying)
+    {
+        fputc(REPLAY_END_GAME, recorder.file);
+    }
+}
+
+/*
+Function: void replayGame(GhostBehaviorContext *ghostContext, HunterBehaviorContext *hunterContexts[])
+Purpose: Plays the turns of one recorded game back in order, on this thread and without waiting between them.
+in/out: ghostContext - Pointer to the ghost's GhostBehaviorContext
+in/out: hunterContexts - Array of NUM_HUNTERS pointers to the hunters' HunterBehaviorContext
+return: none
+*/
+void replayGame(GhostBehaviorContext *ghostContext, HunterBehaviorContext *hunterContexts[])
+{
+    while (C_TRUE)
+    {
+        int tag = fgetc(recorder.file);
+        if (tag == REPLAY_END_GAME || tag == EOF)
+        {
+            break;
+        }
+        if (tag > NUM_HUNTERS)
+        {
+            printf("Error: Replay diverged, found record %d where a turn was expected\n", tag);
+            exit(1);
+        }
+
+        recorder.numDraws = fgetc(recorder.file);
+        if (fread(recorder.draws, sizeof(int), recorder.numDraws, recorder.file) != (size_t)recorder.numDraws)
+        {
+            printf("Error: Recording ends in the middle of a turn\n");
+            exit(1);
+        }
+        recorder.nextDraw = 0;
+        recorder.stepAgent = tag;
+
+        if (tag == GHOST_AGENT)
+        {
+            stepGhost(ghostContext);
+        }
+        else
+        {
+            stepHunter(hunterContexts[tag - 1]);
+        }
+
+        if (recorder.nextDraw != recorder.numDraws)
+        {
+            printf("Error: Replay diverged, agent %d drew fewer random numbers than recorded\n", tag);
+            exit(1);
+        }
+        recorder.stepAgent = -1;
+    }
+}
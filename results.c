@@ -0,0 +1,267 @@
+#include "defs.h"
+#include <stddef.h>
+
+// where each column's value sits in a ResultRecordType and how wide it is
+static const struct {
+    size_t offset;
+    int width;
+} resultColumns[RESULT_COLUMNS] = {
+    [COL_NUM_ROOMS]   = { offsetof(ResultRecordType, numRooms),     sizeof(int32_t) },
+    [COL_POLICY]      = { offsetof(ResultRecordType, hunterPolicy), sizeof(uint8_t) },
+    [COL_FADE_TIME]   = { offsetof(ResultRecordType, fadeTime),     sizeof(int64_t) },
+    [COL_SEED]        = { offsetof(ResultRecordType, seed),         sizeof(uint32_t) },
+    [COL_WINNER]      = { offsetof(ResultRecordType, winner),       sizeof(uint8_t) },
+    [COL_GHOST]       = { offsetof(ResultRecordType, ghostClass),   sizeof(uint8_t) },
+    [COL_IDENTIFIED]  = { offsetof(ResultRecordType, identified),   sizeof(uint8_t) },
+    [COL_LENGTH]      = { offsetof(ResultRecordType, length),       sizeof(int64_t) },
+    [COL_EXIT_REASON] = { offsetof(ResultRecordType, exitReason),   NUM_HUNTERS * sizeof(uint8_t) },
+    [COL_EXIT_TIME]   = { offsetof(ResultRecordType, exitTime),     NUM_HUNTERS * sizeof(int64_t) },
+    [COL_EVIDENCE]    = { offsetof(ResultRecordType, evidence),     sizeof(uint8_t) },
+};
+
+/*
+Function: int readResultsFooter(ResultsWriterType *writer, FILE *file)
+Purpose: Loads the block index of an existing results file so new games can be appended after its last block.
+in/out: writer - Pointer to the ResultsWriterType structure receiving the index
+in: file - The results file, opened for reading and writing
+return: Returns 0 on success, -1 if the file isn't a results file with the same columns
+*/
+static int readResultsFooter(ResultsWriterType *writer, FILE *file)
+{
+    ResultsTrailerType trailer;
+    if (fseek(file, -(long)sizeof(trailer), SEEK_END) != 0 || fread(&trailer, sizeof(trailer), 1, file) != 1 ||
+        trailer.magic != RESULTS_MAGIC || trailer.numColumns != RESULT_COLUMNS)
+    {
+        return -1;
+    }
+
+    int32_t widths[RESULT_COLUMNS];
+    writer->blockCapacity = trailer.numBlocks + 16;
+    writer->blocks = malloc(writer->blockCapacity * sizeof(ResultsBlockType));
+    if (writer->blocks == NULL)
+    {
+        printf("Error allocating memory for results index\n");
+        exit(1);
+    }
+    if (fseek(file, trailer.indexOffset, SEEK_SET) != 0 ||
+        fread(writer->blocks, sizeof(ResultsBlockType), trailer.numBlocks, file) != (size_t)trailer.numBlocks ||
+        fread(widths, sizeof(int32_t), RESULT_COLUMNS, file) != RESULT_COLUMNS)
+    {
+        return -1;
+    }
+    for (int column = 0; column < RESULT_COLUMNS; column++)
+    {
+        if (widths[column] != resultColumns[column].width)
+        {
+            return -1;
+        }
+    }
+
+    // the new blocks overwrite the old footer, a bigger one is written when the file is closed
+    writer->numBlocks = trailer.numBlocks;
+    writer->numGames = trailer.numGames;
+    fseek(file, trailer.indexOffset, SEEK_SET);
+    return 0;
+}
+
+/*
+Function: ResultsWriterType *openResults(const char *path)
+Purpose: Opens a results file to append games to, creating it if it doesn't exist.
+in: path - Path of the results file
+return: Returns a pointer to the new ResultsWriterType structure, or NULL if the file can't be used
+*/
+ResultsWriterType *openResults(const char *path)
+{
+    ResultsWriterType *writer = calloc(1, sizeof(ResultsWriterType));
+    if (writer == NULL)
+    {
+        printf("Error allocating memory for results\n");
+        exit(1);
+    }
+    sem_init(&writer->lock, 0, 1);
+    for (int column = 0; column < RESULT_COLUMNS; column++)
+    {
+        writer->columns[column] = malloc(RESULTS_BLOCK_GAMES * resultColumns[column].width);
+        if (writer->columns[column] == NULL)
+        {
+            printf("Error allocating memory for results\n");
+            exit(1);
+        }
+    }
+
+    writer->file = fopen(path, "r+b");
+    if (writer->file != NULL)
+    {
+        if (readResultsFooter(writer, writer->file) != 0)
+        {
+            printf("Error: %s is not a results file\n", path);
+            fclose(writer->file);
+            writer->file = NULL;
+        }
+    }
+    else
+    {
+        writer->file = fopen(path, "wb");
+        if (writer->file == NULL)
+        {
+            printf("Error: Failed to create results file %s\n", path);
+        }
+    }
+
+    if (writer->file == NULL)
+    {
+        for (int column = 0; column < RESULT_COLUMNS; column++)
+        {
+            free(writer->columns[column]);
+        }
+        free(writer->blocks);
+        sem_destroy(&writer->lock);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+/*
+Function: void flushResults(ResultsWriterType *writer)
+Purpose: Writes the buffered games as a block, one column after the other, and adds the block to the index.
+in/out: writer - Pointer to the ResultsWriterType structure
+return: none
+*/
+static void flushResults(ResultsWriterType *writer)
+{
+    if (writer->blockGames == 0)
+    {
+        return;
+    }
+
+    if (writer->numBlocks == writer->blockCapacity)
+    {
+        writer->blockCapacity = writer->blockCapacity > 0 ? writer->blockCapacity * 2 : 16;
+        writer->blocks = realloc(writer->blocks, writer->blockCapacity * sizeof(ResultsBlockType));
+        if (writer->blocks == NULL)
+        {
+            printf("Error allocating memory for results index\n");
+            exit(1);
+        }
+    }
+
+    ResultsBlockType *block = &writer->blocks[writer->numBlocks++];
+    block->offset = ftell(writer->file);
+    block->numGames = writer->blockGames;
+    block->reserved = 0;
+    // every column starts 8 byte aligned so readers can use the mapped values in place
+    static const uint8_t padding[8] = {0};
+    for (int column = 0; column < RESULT_COLUMNS; column++)
+    {
+        size_t size = (size_t)resultColumns[column].width * writer->blockGames;
+        fwrite(writer->columns[column], 1, size, writer->file);
+        fwrite(padding, 1, (8 - size % 8) % 8, writer->file);
+    }
+    writer->blockGames = 0;
+}
+
+/*
+Function: ResultsWriterType *openMemoryResults(ResultRecordType *records, int64_t capacity, int64_t numGames)
+Purpose: Opens a results writer that keeps the records in an array instead of a file, e.g. one shared with another process.
+in/out: records - Array the records are written to
+in: capacity - Number of records the array holds
+in: numGames - Number of records already in the array, new ones go after them
+return: Returns a pointer to the new ResultsWriterType structure
+*/
+ResultsWriterType *openMemoryResults(ResultRecordType *records, int64_t capacity, int64_t numGames)
+{
+    ResultsWriterType *writer = calloc(1, sizeof(ResultsWriterType));
+    if (writer == NULL)
+    {
+        printf("Error allocating memory for results\n");
+        exit(1);
+    }
+    sem_init(&writer->lock, 0, 1);
+    writer->records = records;
+    writer->capacity = capacity;
+    writer->numGames = numGames;
+    return writer;
+}
+
+/*
+Function: void appendResult(ResultsWriterType *writer, ResultRecordType *record)
+Purpose: Adds a finished game to the results, writing a block each time RESULTS_BLOCK_GAMES games have been added.
+         Safe to call from several threads at once.
+in/out: writer - Pointer to the ResultsWriterType structure
+in: record - Pointer to the ResultRecordType structure of the game
+return: none
+*/
+void appendResult(ResultsWriterType *writer, ResultRecordType *record)
+{
+    sem_wait(&writer->lock);
+    if (writer->records != NULL)
+    {
+        if (writer->numGames < writer->capacity)
+        {
+            writer->records[writer->numGames++] = *record;
+        }
+        sem_post(&writer->lock);
+        return;
+    }
+    for (int column = 0; column < RESULT_COLUMNS; column++)
+    {
+        int width = resultColumns[column].width;
+        memcpy(writer->columns[column] + (size_t)writer->blockGames * width, (uint8_t *)record + resultColumns[column].offset, width);
+    }
+    writer->blockGames++;
+    writer->numGames++;
+
+    if (writer->blockGames == RESULTS_BLOCK_GAMES)
+    {
+        flushResults(writer);
+    }
+    sem_post(&writer->lock);
+}
+
+/*
+Function: void closeResults(ResultsWriterType *writer)
+Purpose: Writes the last block and the footer, then closes the results file.
+in/out: writer - Pointer to the ResultsWriterType structure to be freed
+return: none
+*/
+void closeResults(ResultsWriterType *writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    if (writer->records != NULL)
+    {
+        // the records belong to whoever gave the array
+        sem_destroy(&writer->lock);
+        free(writer);
+        return;
+    }
+
+    flushResults(writer);
+
+    ResultsTrailerType trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    trailer.magic = RESULTS_MAGIC;
+    trailer.numColumns = RESULT_COLUMNS;
+    trailer.numBlocks = writer->numBlocks;
+    trailer.indexOffset = ftell(writer->file);
+    trailer.numGames = writer->numGames;
+    fwrite(writer->blocks, sizeof(ResultsBlockType), writer->numBlocks, writer->file);
+    for (int column = 0; column < RESULT_COLUMNS; column++)
+    {
+        int32_t width = resultColumns[column].width;
+        fwrite(&width, sizeof(width), 1, writer->file);
+    }
+    fwrite(&trailer, sizeof(trailer), 1, writer->file);
+    fclose(writer->file);
+
+    for (int column = 0; column < RESULT_COLUMNS; column++)
+    {
+        free(writer->columns[column]);
+    }
+    free(writer->blocks);
+    sem_destroy(&writer->lock);
+    free(writer);
+}
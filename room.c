@@ -35,6 +35,7 @@ void initRoom(RoomType *room, const char *name)
     //GitHub, Inc. "GitHub Copilot." GitHub Copilot, 2021, https://copilot.github.com/.
     // co pilot was used to write this code
     strcpy(room->name, name);
+    room->id = -1;
     room->roomlist = NULL;
     room->evidencelist = malloc(sizeof(EvidenceListType));
     if (room->evidencelist != NULL)
@@ -47,18 +48,11 @@ void initRoom(RoomType *room, const char *name)
         printf("Error: Failed to allocate memory for evidence list\n");
     }
 
-    // Initialize hunter array with allocating memory
-    room->hunterArray = malloc(sizeof(HunterArrayType));
-    // call initHunterArray to initialize the hunter array
-    if (room->hunterArray != NULL)
-    {
-        initHunterArray(room->hunterArray, NUM_HUNTERS);
-    }
-    else
-    {
-        // Handle allocation error
-        printf("Error: Failed to allocate memory for hunter array\n");
-    }
+    // The room's hunter count and hunter ids live in its house's occupancy, set up when a game starts
+    room->occupancy = NULL;
+    room->occupancyShift = 0;
+    room->occupants = NULL;
+    room->numOccupants = 0;
 
     room->ghost = NULL;
 }
@@ -160,6 +154,249 @@ void connectRooms(RoomType *room1, RoomType *room2)
     addRoom(room2->roomlist, room1);
 }
 
+/*
+Function: void createOccupancy(HouseType *house, int maxHunters)
+Purpose: Gives the rooms of a house their hunter counts, all zero, OCCUPANCY_ROOMS rooms with consecutive ids to a shard,
+         and an empty list of hunter ids each.
+in/out: house - Pointer to the HouseType structure, its rooms must be indexed
+in: maxHunters - Most hunters that can be in one room, at most 1 << OCCUPANCY_BITS - 1
+return: none
+*/
+void createOccupancy(HouseType *house, int maxHunters)
+{
+    int numRooms = house->index->numRooms;
+    house->numShards = (numRooms + OCCUPANCY_ROOMS - 1) / OCCUPANCY_ROOMS;
+    house->occupancy = aligned_alloc(CACHE_LINE, house->numShards * sizeof(OccupancyShardType));
+    house->occupants = malloc(numRooms * maxHunters);
+    if (house->occupancy == NULL || house->occupants == NULL)
+    {
+        printf("Error allocating memory for occupancy\n");
+        exit(1);
+    }
+    resetOccupancy(house, maxHunters);
+}
+
+/*
+Function: void resetOccupancy(HouseType *house, int maxHunters)
+Purpose: Empties every room of a house of hunters again and points the rooms at their counts and lists, for a new
+         game in rooms copied over the last one's.
+in/out: house - Pointer to the HouseType structure, its occupancy made by createOccupancy with the same maxHunters
+in: maxHunters - Most hunters that can be in one room
+return: none
+*/
+void resetOccupancy(HouseType *house, int maxHunters)
+{
+    int numRooms = house->index->numRooms;
+    for (int i = 0; i < house->numShards; i++)
+    {
+        house->occupancy[i].counts = 0;
+        house->occupancy[i].version = 0;
+        sem_init(&house->occupancy[i].sem, 0, 1);
+    }
+    for (int i = 0; i < numRooms; i++)
+    {
+        house->index->rooms[i]->occupancy = &house->occupancy[i / OCCUPANCY_ROOMS];
+        house->index->rooms[i]->occupancyShift = (i % OCCUPANCY_ROOMS) * OCCUPANCY_BITS;
+        house->index->rooms[i]->occupants = &house->occupants[i * maxHunters];
+        house->index->rooms[i]->numOccupants = 0;
+    }
+}
+
+/*
+Function: void freeOccupancy(HouseType *house)
+Purpose: Frees the hunter counts and hunter ids of the rooms of a house.
+in/out: house - Pointer to the HouseType structure, its occupancy may be NULL
+return: none
+*/
+void freeOccupancy(HouseType *house)
+{
+    if (house->occupancy == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < house->numShards; i++)
+    {
+        sem_destroy(&house->occupancy[i].sem);
+    }
+    free(house->occupancy);
+    free(house->occupants);
+    house->occupancy = NULL;
+    house->occupants = NULL;
+}
+
+/*
+Function: void appendOccupant(RoomType *room, HunterType *hunter)
+Purpose: Adds a hunter's id to the end of a room's list and remembers the slot it was given. The caller holds the
+         room's shard semaphore.
+in/out: room - Pointer to the RoomType structure
+in/out: hunter - Pointer to the house's HunterType structure for the hunter, its slot is set
+return: none
+*/
+static void appendOccupant(RoomType *room, HunterType *hunter)
+{
+    hunter->slot = room->numOccupants;
+    room->occupants[room->numOccupants++] = (unsigned char)hunter->id;
+}
+
+/*
+Function: void dropOccupant(RoomType *room, HunterType *hunter, HunterType *allHunters)
+Purpose: Removes a hunter's id from a room's list in O(1), moving the last id into its slot. The caller holds the
+         room's shard semaphore.
+in/out: room - Pointer to the RoomType structure
+in/out: hunter - Pointer to the house's HunterType structure for the hunter, its slot is cleared
+in/out: allHunters - Array of every hunter indexed by id, the hunter moved into the gap has its slot updated
+return: none
+*/
+static void dropOccupant(RoomType *room, HunterType *hunter, HunterType *allHunters)
+{
+    int last = room->occupants[--room->numOccupants];
+    if (hunter->slot != room->numOccupants)
+    {
+        room->occupants[hunter->slot] = (unsigned char)last;
+        allHunters[last].slot = hunter->slot;
+    }
+    hunter->slot = -1;
+}
+
+/*
+Function: void addOccupant(RoomType *room, HunterType *hunter)
+Purpose: Puts a hunter entering from outside the house in a room's list and count.
+in/out: room - Pointer to the RoomType structure the hunter entered
+in/out: hunter - Pointer to the house's HunterType structure for the hunter, its slot is set
+return: none
+*/
+void addOccupant(RoomType *room, HunterType *hunter)
+{
+    sem_wait(&room->occupancy->sem);
+    appendOccupant(room, hunter);
+    __atomic_fetch_add(&room->occupancy->counts, 1UL << room->occupancyShift, __ATOMIC_RELEASE);
+    sem_post(&room->occupancy->sem);
+}
+
+/*
+Function: void removeOccupant(HunterType *hunter, HunterType *allHunters)
+Purpose: Takes a hunter leaving the house out of its room's list and count. Its room is left set, to say where it left.
+in/out: hunter - Pointer to the house's HunterType structure for the hunter, its slot is cleared
+in/out: allHunters - Array of every hunter indexed by id, the hunter moved into the gap has its slot updated
+return: none
+*/
+void removeOccupant(HunterType *hunter, HunterType *allHunters)
+{
+    RoomType *room = hunter->room;
+    sem_wait(&room->occupancy->sem);
+    dropOccupant(room, hunter, allHunters);
+    __atomic_fetch_sub(&room->occupancy->counts, 1UL << room->occupancyShift, __ATOMIC_RELEASE);
+    sem_post(&room->occupancy->sem);
+}
+
+/*
+Function: void moveOccupant(HunterType *hunter, RoomType *to, HunterType *allHunters)
+Purpose: Moves a hunter from its room to another as one step, so no reader ever counts it in neither room or in both,
+         and its id leaves one list and joins the other in the same step. The counts can be read without waiting:
+         between rooms of the same shard they change with one atomic add. A move between shards takes both shards'
+         semaphores, the one at the lower address first so two moves through the same doorway in opposite
+         directions can't deadlock, and marks the shards' versions odd while it changes them.
+in/out: hunter - Pointer to the HunterType structure being moved, its room and slot are set
+in/out: to - Pointer to the RoomType structure the hunter enters
+in/out: allHunters - Array of every hunter indexed by id, the hunter moved into the gap it leaves has its slot updated
+return: none
+*/
+void moveOccupant(HunterType *hunter, RoomType *to, HunterType *allHunters)
+{
+    RoomType *from = hunter->room;
+    OccupancyShardType *fromShard = from->occupancy;
+    OccupancyShardType *toShard = to->occupancy;
+    if (fromShard == toShard)
+    {
+        // the semaphore only keeps the lists in step, the counts can't borrow or carry into each other so the
+        // difference is added in one go and readers never wait on it
+        sem_wait(&fromShard->sem);
+        dropOccupant(from, hunter, allHunters);
+        appendOccupant(to, hunter);
+        __atomic_fetch_add(&fromShard->counts, (1UL << to->occupancyShift) - (1UL << from->occupancyShift), __ATOMIC_RELEASE);
+        hunter->room = to;
+        sem_post(&fromShard->sem);
+        return;
+    }
+
+    OccupancyShardType *first = fromShard < toShard ? fromShard : toShard;
+    OccupancyShardType *second = fromShard < toShard ? toShard : fromShard;
+    sem_wait(&first->sem);
+    sem_wait(&second->sem);
+    // a reader that sees either new count also sees an odd version, so it tries again
+    __atomic_store_n(&fromShard->version, fromShard->version + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&toShard->version, toShard->version + 1, __ATOMIC_RELAXED);
+    dropOccupant(from, hunter, allHunters);
+    appendOccupant(to, hunter);
+    __atomic_fetch_sub(&fromShard->counts, 1UL << from->occupancyShift, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&toShard->counts, 1UL << to->occupancyShift, __ATOMIC_RELEASE);
+    hunter->room = to;
+    __atomic_store_n(&fromShard->version, fromShard->version + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&toShard->version, toShard->version + 1, __ATOMIC_RELEASE);
+    sem_post(&second->sem);
+    sem_post(&first->sem);
+}
+
+/*
+Function: int countOccupants(RoomType *room)
+Purpose: Reads how many hunters are in a room, without waiting.
+in: room - Pointer to the RoomType structure
+return: Returns the number of hunters in the room
+*/
+int countOccupants(RoomType *room)
+{
+    uint64_t counts = __atomic_load_n(&room->occupancy->counts, __ATOMIC_ACQUIRE);
+    return (int)((counts >> room->occupancyShift) & ((1UL << OCCUPANCY_BITS) - 1));
+}
+
+/*
+Function: void readOccupants(RoomType *room1, RoomType *room2, int *count1, int *count2)
+Purpose: Reads how many hunters are in two rooms at the same moment, so a hunter moving between them is counted
+         exactly once. The counts are read again if a move between shards overlapped them, and read under the
+         shards' semaphores if that keeps happening.
+in: room1 - Pointer to the first RoomType structure
+in: room2 - Pointer to the second RoomType structure
+out: count1 - Number of hunters in the first room
+out: count2 - Number of hunters in the second room
+return: none
+*/
+void readOccupants(RoomType *room1, RoomType *room2, int *count1, int *count2)
+{
+    OccupancyShardType *shard1 = room1->occupancy;
+    OccupancyShardType *shard2 = room2->occupancy;
+    if (shard1 == shard2)
+    {
+        // one load sees both counts at once
+        uint64_t counts = __atomic_load_n(&shard1->counts, __ATOMIC_ACQUIRE);
+        *count1 = (int)((counts >> room1->occupancyShift) & ((1UL << OCCUPANCY_BITS) - 1));
+        *count2 = (int)((counts >> room2->occupancyShift) & ((1UL << OCCUPANCY_BITS) - 1));
+        return;
+    }
+
+    // optimistic reads can keep losing to a stream of moves, so after a few tries the moves are held off instead
+    for (int tries = 0; tries < OCCUPANCY_READ_TRIES; tries++)
+    {
+        unsigned int before1 = __atomic_load_n(&shard1->version, __ATOMIC_ACQUIRE);
+        unsigned int before2 = __atomic_load_n(&shard2->version, __ATOMIC_ACQUIRE);
+        *count1 = countOccupants(room1);
+        *count2 = countOccupants(room2);
+        if (((before1 | before2) & 1) == 0 && __atomic_load_n(&shard1->version, __ATOMIC_RELAXED) == before1 &&
+            __atomic_load_n(&shard2->version, __ATOMIC_RELAXED) == before2)
+        {
+            return;
+        }
+    }
+
+    OccupancyShardType *first = shard1 < shard2 ? shard1 : shard2;
+    OccupancyShardType *second = shard1 < shard2 ? shard2 : shard1;
+    sem_wait(&first->sem);
+    sem_wait(&second->sem);
+    *count1 = countOccupants(room1);
+    *count2 = countOccupants(room2);
+    sem_post(&second->sem);
+    sem_post(&first->sem);
+}
+
 /*
 Function: void freeRoomList(RoomListType *roomList)
 Purpose: Frees the memory allocated for the nodes in a RoomListType structure.
@@ -201,13 +438,6 @@ void freeRoom(RoomType *room)
         freeEvidenceList(room->evidencelist); // This function should free the entire list and its contents
     }
 
-    // Free the hunter array
-    if (room->hunterArray != NULL)
-    {
-        clearHunterArray(room->hunterArray); // This function should free the contents of the hunter array
-        free(room->hunterArray);             // Free the hunter array structure itself
-    }
-
     // free room list
     if (room->roomlist != NULL)
     {
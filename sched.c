@@ -0,0 +1,355 @@
+#include "defs.h"
+
+/*
+Function: int ghostTurn(void *context)
+Purpose: Takes one turn of a ghost agent.
+in/out: context - Pointer to the GhostBehaviorContext structure of the ghost
+return: Returns C_TRUE if the ghost keeps playing, C_FALSE once the game is over
+*/
+static int ghostTurn(void *context)
+{
+    return stepGhost((GhostBehaviorContext *)context);
+}
+
+/*
+Function: int hunterTurn(void *context)
+Purpose: Takes one turn of a hunter agent.
+in/out: context - Pointer to the HunterBehaviorContext structure of the hunter
+return: Returns C_TRUE if the hunter keeps playing, C_FALSE once it has left or the game is over
+*/
+static int hunterTurn(void *context)
+{
+    HunterBehaviorContext *hunterContext = (HunterBehaviorContext *)context;
+    int playing = stepHunter(hunterContext);
+    if (!playing)
+    {
+        countActiveHunters(hunterContext->sharedState->stats, -1);
+    }
+    return playing;
+}
+
+/*
+Function: void initScheduler(SchedulerType *scheduler)
+Purpose: Initializes a worker's scheduler with no agents.
+in/out: scheduler - Pointer to the SchedulerType structure to be initialized
+return: none
+*/
+void initScheduler(SchedulerType *scheduler)
+{
+    initTimerWheel(&scheduler->wheel);
+    scheduler->turns = 0;
+}
+
+/*
+Function: void addAgent(SchedulerType *scheduler, AgentType *agent)
+Purpose: Gives an agent to a worker's scheduler, it takes its first turn in the next tick.
+in/out: scheduler - Pointer to the SchedulerType structure, it must not be running yet unless this is its own worker
+in/out: agent - Pointer to the AgentType structure, it must stay where it is until the scheduler has run
+return: none
+*/
+void addAgent(SchedulerType *scheduler, AgentType *agent)
+{
+    addTimer(&scheduler->wheel, agent, 1);
+}
+
+/*
+Function: int runTurnsUntil(SchedulerType *scheduler, int (*pause)(void *arg), void *arg)
+Purpose: Takes the turns of the agents of one scheduler tick by tick, until none of them is left playing or, after a
+         tick, pause says to stop. Every agent is then back on the wheel, so calling it again carries on where it stopped.
+         An agent that is done runs its finished hook, if it has one, which may give the worker new agents.
+         The worker owns its wheel, so turns are taken without any locking between workers.
+in/out: scheduler - Pointer to the SchedulerType structure of the worker
+in: pause - Checked after every tick, returns C_TRUE to stop, NULL to run until the agents are done
+in/out: arg - Passed to pause
+return: Returns C_TRUE if it stopped because of pause, C_FALSE once no agent is left playing
+*/
+int runTurnsUntil(SchedulerType *scheduler, int (*pause)(void *arg), void *arg)
+{
+    TimerWheelType *wheel = &scheduler->wheel;
+    int paused = C_FALSE;
+
+    // nothing in the game loop should need the heap
+    setAllocPhase(PHASE_RUN);
+    while (!paused && wheel->numTimers > 0)
+    {
+        AgentType *ready = advanceTimerWheel(wheel);
+        while (ready != NULL)
+        {
+            AgentType *agent = ready;
+            ready = agent->next;
+
+            swapRandomState(&agent->seed);
+            int playing = agent->step(agent->context);
+            swapRandomState(&agent->seed);
+            scheduler->turns++;
+
+            // suspended until its wait is over, instead of sleeping on a thread of its own
+            if (playing)
+            {
+                addTimer(wheel, agent, agent->wait);
+            }
+            else if (agent->finished != NULL)
+            {
+                agent->finished(agent, scheduler);
+            }
+        }
+        paused = pause != NULL && wheel->numTimers > 0 && pause(arg);
+    }
+    setAllocPhase(PHASE_TEARDOWN);
+    return paused;
+}
+
+/*
+Function: void *poolWorker(void *param)
+Purpose: Keeps a worker thread warm, running its scheduler's agents each time the pool is started until it is stopped.
+in/out: param - Pointer to the SchedulerType structure of the worker
+return: none
+*/
+static void *poolWorker(void *param)
+{
+    SchedulerType *scheduler = (SchedulerType *)param;
+    while (C_TRUE)
+    {
+        sem_wait(&scheduler->start);
+        if (scheduler->stopping)
+        {
+            break;
+        }
+        runTurnsUntil(scheduler, NULL, NULL);
+        sem_post(scheduler->done);
+    }
+    return NULL;
+}
+
+/*
+Function: void startWorkerPool(WorkerPoolType *pool, int numThreads, PlacementType *placement)
+Purpose: Starts numThreads worker threads that wait for agents to be given to their schedulers.
+in/out: pool - Pointer to the WorkerPoolType structure to be initialized
+in: numThreads - Number of worker threads
+in: placement - Pointer to the PlacementType structure, workers are pinned when it is enabled
+return: none
+*/
+void startWorkerPool(WorkerPoolType *pool, int numThreads, PlacementType *placement)
+{
+    pool->numThreads = numThreads;
+    pool->schedulers = malloc(numThreads * sizeof(SchedulerType));
+    if (pool->schedulers == NULL)
+    {
+        printf("Error allocating memory for worker pool\n");
+        exit(1);
+    }
+    sem_init(&pool->done, 0, 0);
+    for (int i = 0; i < numThreads; i++)
+    {
+        SchedulerType *scheduler = &pool->schedulers[i];
+        initScheduler(scheduler);
+        sem_init(&scheduler->start, 0, 0);
+        scheduler->done = &pool->done;
+        scheduler->stopping = C_FALSE;
+        createPinnedThread(placement, &scheduler->thread, getWorkerCore(placement, i), poolWorker, scheduler);
+    }
+}
+
+/*
+Function: void runWorkerPool(WorkerPoolType *pool)
+Purpose: Runs every agent given to the pool's schedulers to the end and waits for all the workers to finish.
+in/out: pool - Pointer to the WorkerPoolType structure
+return: none
+*/
+void runWorkerPool(WorkerPoolType *pool)
+{
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        sem_post(&pool->schedulers[i].start);
+    }
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        sem_wait(&pool->done);
+    }
+}
+
+/*
+Function: void stopWorkerPool(WorkerPoolType *pool)
+Purpose: Stops and joins the pool's worker threads and frees their schedulers.
+in/out: pool - Pointer to the WorkerPoolType structure, it must not be running
+return: none
+*/
+void stopWorkerPool(WorkerPoolType *pool)
+{
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        pool->schedulers[i].stopping = C_TRUE;
+        sem_post(&pool->schedulers[i].start);
+    }
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        pthread_join(pool->schedulers[i].thread, NULL);
+        sem_destroy(&pool->schedulers[i].start);
+    }
+    sem_destroy(&pool->done);
+    free(pool->schedulers);
+}
+
+/*
+Function: void makeCoopAgents(CoopGameType *coopGame)
+Purpose: Turns the ghost and hunters of a game that is set up into agents, with no finished hook.
+in/out: coopGame - Pointer to the CoopGameType structure whose game is set up
+return: none
+*/
+static void makeCoopAgents(CoopGameType *coopGame)
+{
+    GameType *game = &coopGame->game;
+    initGhostBehaviorContext(&coopGame->ghostContext, game->ghost, &game->house, game->house.hunterArray, &game->state);
+    AgentType *ghostAgent = &coopGame->agents[GHOST_AGENT];
+    ghostAgent->step = ghostTurn;
+    ghostAgent->context = &coopGame->ghostContext;
+    ghostAgent->finished = NULL;
+    ghostAgent->owner = NULL;
+    ghostAgent->seed = agentSeed(game->state.seed, GHOST_AGENT);
+    ghostAgent->wait = GHOST_WAIT / COOP_TICK;
+
+    for (int h = 0; h < NUM_HUNTERS; h++)
+    {
+        HunterBehaviorContext *hunterContext = &coopGame->hunterContexts[h];
+        initHunterBehaviorContext(hunterContext, h + 1, &game->house.hunterArray->hunter[h], game->ghost, &game->house, game->house.evidenceArray, &game->state);
+        AgentType *hunterAgent = &coopGame->agents[h + 1];
+        hunterAgent->step = hunterTurn;
+        hunterAgent->context = hunterContext;
+        hunterAgent->finished = NULL;
+        hunterAgent->owner = NULL;
+        hunterAgent->seed = agentSeed(game->state.seed, h + 1);
+        hunterAgent->wait = HUNTER_WAIT / COOP_TICK;
+        countActiveHunters(game->state.stats, 1);
+    }
+}
+
+/*
+Function: void initCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR])
+Purpose: Sets up a game and turns its ghost and hunters into agents, ready to be given to a scheduler. The agents
+         have no finished hook, the caller can set one afterwards.
+in/out: coopGame - Pointer to the CoopGameType structure to be set up, it must not move until the game is finished
+in: config - Pointer to the SimConfigType structure holding the game's options and seed
+in: hunterNames - Array of NUM_HUNTERS hunter names
+return: none
+*/
+void initCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR])
+{
+    setupGame(&coopGame->game, config, hunterNames);
+    makeCoopAgents(coopGame);
+}
+
+/*
+Function: void startCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR], SchedulerType *scheduler)
+Purpose: Sets up a game and gives its ghost and hunters to a worker's scheduler as agents, they take their first turns
+         in the scheduler's next tick. The agents have no finished hook, the caller can set one afterwards.
+in/out: coopGame - Pointer to the CoopGameType structure to be set up, it must not move until the game is finished
+in: config - Pointer to the SimConfigType structure holding the game's options and seed
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in/out: scheduler - Pointer to the SchedulerType structure of the worker the game is played on
+return: none
+*/
+void startCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR], SchedulerType *scheduler)
+{
+    initCoopGame(coopGame, config, hunterNames);
+    for (int agent = 0; agent <= NUM_HUNTERS; agent++)
+    {
+        addAgent(scheduler, &coopGame->agents[agent]);
+    }
+}
+
+/*
+Function: void restartCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR], SchedulerType *scheduler)
+Purpose: Starts the next game in the memory of a finished one, as resetGame does, and gives its agents to a worker's
+         scheduler. Nothing is allocated, so it can be called from an agent's finished hook while the worker runs.
+in/out: coopGame - Pointer to the CoopGameType structure of a game scored but not freed
+in: config - Pointer to the SimConfigType structure holding the game's options and seed, with the same template
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in/out: scheduler - Pointer to the SchedulerType structure of the worker the game is played on
+return: none
+*/
+void restartCoopGame(CoopGameType *coopGame, SimConfigType *config, char hunterNames[][MAX_STR], SchedulerType *scheduler)
+{
+    resetGame(&coopGame->game, config, hunterNames);
+    makeCoopAgents(coopGame);
+    for (int agent = 0; agent <= NUM_HUNTERS; agent++)
+    {
+        addAgent(scheduler, &coopGame->agents[agent]);
+    }
+}
+
+/*
+Function: void runCoopGames(SimConfigType *config, char hunterNames[][MAX_STR], int games, WorkerPoolType *pool, int wins[], FILE *stream, FILE *summary)
+Purpose: Plays a run of games all at once on the threads of a worker pool, every ghost and hunter an agent of the
+         scheduler of the worker its game was dealt to. Agents wait GHOST_WAIT and HUNTER_WAIT in simulated time,
+         so the games run as fast as the workers can take turns.
+in/out: config - Pointer to the SimConfigType structure, game i is seeded with its seed plus i
+in: hunterNames - Array of NUM_HUNTERS hunter names
+in: games - Number of games to play
+in/out: pool - Pointer to the started WorkerPoolType structure the games are played on
+in/out: wins - Array of RESULT_COUNT counts of games by how they ended, added to
+in/out: stream - Stream a line with the seed, ending and length of each game is written to, NULL for none
+in/out: summary - Stream the timing line of the run is written to, NULL for none
+return: none
+*/
+void runCoopGames(SimConfigType *config, char hunterNames[][MAX_STR], int games, WorkerPoolType *pool, int wins[], FILE *stream, FILE *summary)
+{
+    static const char *endings[RESULT_COUNT] = { "hunters", "ghost", "bored" };
+    int numThreads = pool->numThreads;
+    SchedulerType *schedulers = pool->schedulers;
+    CoopGameType *coopGames = malloc(games * sizeof(CoopGameType));
+    if (coopGames == NULL)
+    {
+        printf("Error allocating memory for games\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        initScheduler(&schedulers[i]);
+    }
+    unsigned int seed = config->seed;
+    for (int i = 0; i < games; i++)
+    {
+        // the agents of a game share a worker, so its turns all happen in the same simulated time
+        config->seed = seed + i;
+        startCoopGame(&coopGames[i], config, hunterNames, &schedulers[i % numThreads]);
+        if (config->stats != NULL)
+        {
+            setStatsRooms(config->stats, &coopGames[i].game.house);
+        }
+    }
+    config->seed = seed;
+
+    int numAgents = games * (NUM_HUNTERS + 1);
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    runWorkerPool(pool);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    setAllocPhase(PHASE_TEARDOWN);
+
+    for (int i = 0; i < games; i++)
+    {
+        GameResult result = finishGame(&coopGames[i].game, config);
+        wins[result]++;
+        if (stream != NULL)
+        {
+            fprintf(stream, "game %u %s %ld\n", coopGames[i].game.state.seed, endings[result], coopGames[i].game.state.clock);
+        }
+    }
+    long turns = 0;
+    long ticks = 0;
+    for (int i = 0; i < numThreads; i++)
+    {
+        turns += schedulers[i].turns;
+        ticks = schedulers[i].wheel.now > ticks ? schedulers[i].wheel.now : ticks;
+    }
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    if (summary != NULL)
+    {
+        fprintf(summary, "\n%d agents on %d threads took %ld turns over %ld ticks in %.2f s (%.0f ns a turn), %zu bytes of agent state per hunter\n",
+                numAgents, numThreads, turns, ticks, seconds, seconds * 1e9 / (turns > 0 ? turns : 1), sizeof(AgentType) + sizeof(HunterBehaviorContext));
+    }
+
+    free(coopGames);
+}
@@ -0,0 +1,193 @@
+#include "defs.h"
+
+/*
+Function: int sketchBucket(long value)
+Purpose: Finds the bucket of a value. Values below 2 * 2^SKETCH_SUB_BITS have a bucket each, larger ones share a bucket
+         with the values that have the same highest SKETCH_SUB_BITS + 1 bits, so every bucket is at most 1 / 2^SKETCH_SUB_BITS
+         of its values wide.
+in: value - The value, negative values count as 0
+return: Returns the index of the bucket
+*/
+static int sketchBucket(long value)
+{
+    if (value < (2L << SKETCH_SUB_BITS))
+    {
+        return value > 0 ? (int)value : 0;
+    }
+    int shift = (63 - __builtin_clzl((unsigned long)value)) - SKETCH_SUB_BITS;
+    return (shift << SKETCH_SUB_BITS) + (int)(value >> shift);
+}
+
+/*
+Function: long sketchBucketValue(int bucket)
+Purpose: Gives the value a bucket stands for, the middle of the values it holds.
+in: bucket - Index of the bucket
+return: Returns the value
+*/
+static long sketchBucketValue(int bucket)
+{
+    if (bucket < (2 << SKETCH_SUB_BITS))
+    {
+        return bucket;
+    }
+    int shift = (bucket >> SKETCH_SUB_BITS) - 1;
+    long low = (long)((bucket & ((1 << SKETCH_SUB_BITS) - 1)) | (1 << SKETCH_SUB_BITS)) << shift;
+    return low + ((1L << shift) - 1) / 2;
+}
+
+/*
+Function: void initSketch(SketchType *sketch)
+Purpose: Empties a sketch.
+in/out: sketch - Pointer to the SketchType structure to be initialized
+return: none
+*/
+void initSketch(SketchType *sketch)
+{
+    memset(sketch, 0, sizeof(SketchType));
+}
+
+/*
+Function: void addToSketch(SketchType *sketch, long value)
+Purpose: Counts a value in a sketch, in constant time and without allocating.
+in/out: sketch - Pointer to the SketchType structure
+in: value - The value
+return: none
+*/
+void addToSketch(SketchType *sketch, long value)
+{
+    sketch->min = sketch->count == 0 || value < sketch->min ? value : sketch->min;
+    sketch->max = sketch->count == 0 || value > sketch->max ? value : sketch->max;
+    sketch->count++;
+    sketch->sum += value;
+    sketch->buckets[sketchBucket(value)]++;
+}
+
+/*
+Function: void mergeSketch(SketchType *into, SketchType *from)
+Purpose: Adds the values counted in one sketch to another, as if they had all been added to it.
+in/out: into - Pointer to the SketchType structure added to
+in: from - Pointer to the SketchType structure added
+return: none
+*/
+void mergeSketch(SketchType *into, SketchType *from)
+{
+    if (from->count == 0)
+    {
+        return;
+    }
+    into->min = into->count == 0 || from->min < into->min ? from->min : into->min;
+    into->max = into->count == 0 || from->max > into->max ? from->max : into->max;
+    into->count += from->count;
+    into->sum += from->sum;
+    for (int bucket = 0; bucket < SKETCH_BUCKETS; bucket++)
+    {
+        into->buckets[bucket] += from->buckets[bucket];
+    }
+}
+
+/*
+Function: long sketchQuantile(SketchType *sketch, double quantile)
+Purpose: Finds the value below which the given share of the values in a sketch lie, to within the width of its bucket.
+in: sketch - Pointer to the SketchType structure, not empty
+in: quantile - The share of values, between 0 and 1
+return: Returns the value, never below the smallest or above the largest value counted
+*/
+long sketchQuantile(SketchType *sketch, double quantile)
+{
+    long target = (long)(sketch->count * quantile);
+    long seen = 0;
+    for (int bucket = 0; bucket < SKETCH_BUCKETS; bucket++)
+    {
+        seen += sketch->buckets[bucket];
+        if (seen > target)
+        {
+            long value = sketchBucketValue(bucket);
+            value = value < sketch->min ? sketch->min : value;
+            return value > sketch->max ? sketch->max : value;
+        }
+    }
+    return sketch->max;
+}
+
+/*
+Function: void initGameSketch(GameSketchType *sketch)
+Purpose: Empties the sketches of every measure of a run of games.
+in/out: sketch - Pointer to the GameSketchType structure to be initialized
+return: none
+*/
+void initGameSketch(GameSketchType *sketch)
+{
+    for (int measure = 0; measure < MEASURE_COUNT; measure++)
+    {
+        initSketch(&sketch->measures[measure]);
+    }
+}
+
+/*
+Function: void recordGameSketch(GameSketchType *sketch, GameType *game)
+Purpose: Counts a game that has been played out: its length, when the first evidence was collected if any was, and
+         when each hunter that was scared or bored out left.
+in/out: sketch - Pointer to the GameSketchType structure
+in: game - Pointer to the GameType structure of the finished game, before its house is freed
+return: none
+*/
+void recordGameSketch(GameSketchType *sketch, GameType *game)
+{
+    addToSketch(&sketch->measures[MEASURE_LENGTH], game->state.clock);
+    if (game->state.firstEvidence >= 0)
+    {
+        addToSketch(&sketch->measures[MEASURE_FIRST_EVIDENCE], game->state.firstEvidence);
+    }
+    for (int i = 0; i < game->house.hunterArray->size; i++)
+    {
+        HunterType *hunter = &game->house.hunterArray->hunter[i];
+        if (hunter->exitReason == LOG_FEAR)
+        {
+            addToSketch(&sketch->measures[MEASURE_FEAR_EXIT], hunter->exitTime);
+        }
+        else if (hunter->exitReason == LOG_BORED)
+        {
+            addToSketch(&sketch->measures[MEASURE_BOREDOM_EXIT], hunter->exitTime);
+        }
+    }
+}
+
+/*
+Function: void mergeGameSketch(GameSketchType *into, GameSketchType *from)
+Purpose: Adds every measure of one run's sketches to another's, e.g. a worker's to the run's totals.
+in/out: into - Pointer to the GameSketchType structure added to
+in: from - Pointer to the GameSketchType structure added
+return: none
+*/
+void mergeGameSketch(GameSketchType *into, GameSketchType *from)
+{
+    for (int measure = 0; measure < MEASURE_COUNT; measure++)
+    {
+        mergeSketch(&into->measures[measure], &from->measures[measure]);
+    }
+}
+
+/*
+Function: void printGameSketch(GameSketchType *sketch)
+Purpose: Prints the percentiles of every measure of a run of games, in ghost updates.
+in: sketch - Pointer to the GameSketchType structure
+return: none
+*/
+void printGameSketch(GameSketchType *sketch)
+{
+    const char *names[MEASURE_COUNT] = {"Game length", "First evidence", "Fear exit", "Boredom exit"};
+    printf("\nPercentiles in ghost updates\n");
+    printf("=================================\n");
+    printf("%-16s %10s %8s %8s %8s %8s %8s\n", "Measure", "Count", "Mean", "p50", "p99", "p99.9", "Max");
+    for (int measure = 0; measure < MEASURE_COUNT; measure++)
+    {
+        SketchType *values = &sketch->measures[measure];
+        if (values->count == 0)
+        {
+            printf("%-16s %10d\n", names[measure], 0);
+            continue;
+        }
+        printf("%-16s %10ld %8.1f %8ld %8ld %8ld %8ld\n", names[measure], values->count, (double)values->sum / values->count,
+               sketchQuantile(values, 0.5), sketchQuantile(values, 0.99), sketchQuantile(values, 0.999), values->max);
+    }
+}
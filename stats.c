@@ -0,0 +1,258 @@
+#include "defs.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/*
+Function: void publishStats(StatsType *stats)
+Purpose: Copies the current counters into the shared memory segment under its seqlock.
+in/out: stats - Pointer to the StatsType structure, its segment is rewritten
+return: none
+*/
+static void publishStats(StatsType *stats)
+{
+    LiveStatsType *live = stats->live;
+
+    // rate since the last publish, from the monotonic clock so it isn't thrown off by clock changes
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long updates = __atomic_load_n(&stats->updates, __ATOMIC_RELAXED);
+    double elapsed = (now.tv_sec - stats->lastPublish.tv_sec) + (now.tv_nsec - stats->lastPublish.tv_nsec) / 1e9;
+    double updatesPerSec = elapsed > 0 ? (updates - stats->lastUpdates) / elapsed : 0;
+    stats->lastPublish = now;
+    stats->lastUpdates = updates;
+
+    // an odd sequence tells readers a write is in progress
+    unsigned int sequence = live->sequence;
+    __atomic_store_n(&live->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    live->gamesCompleted = __atomic_load_n(&stats->gamesCompleted, __ATOMIC_RELAXED);
+    for (int i = 0; i < RESULT_COUNT; i++)
+    {
+        live->wins[i] = __atomic_load_n(&stats->wins[i], __ATOMIC_RELAXED);
+    }
+    live->activeHunters = __atomic_load_n(&stats->activeHunters, __ATOMIC_RELAXED);
+    char (*roomNames)[MAX_STR] = STATS_ROOM_NAMES(live);
+    long *roomDwell = STATS_ROOM_DWELL(live);
+    sem_wait(&stats->roomsLock);
+    live->numRooms = stats->numRooms;
+    live->roomsPlayed = stats->roomsPlayed;
+    for (int i = 0; i < stats->numRooms; i++)
+    {
+        strcpy(roomNames[i], stats->roomNames[i]);
+    }
+    sem_post(&stats->roomsLock);
+    for (int i = 0; i < live->numRooms; i++)
+    {
+        roomDwell[i] = __atomic_load_n(&stats->roomDwell[i], __ATOMIC_RELAXED);
+    }
+    live->evidenceCollected = __atomic_load_n(&stats->evidenceCollected, __ATOMIC_RELAXED);
+    live->updates = updates;
+    live->updatesPerSec = updatesPerSec;
+
+    __atomic_store_n(&live->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/*
+Function: void *statsPublisher(void *param)
+Purpose: Publishes the counters every STATS_INTERVAL microseconds so the simulation threads never touch the segment.
+in/out: param - Pointer to the StatsType structure to publish
+return: none
+*/
+static void *statsPublisher(void *param)
+{
+    StatsType *stats = (StatsType *)param;
+    while (__atomic_load_n(&stats->running, __ATOMIC_ACQUIRE))
+    {
+        publishStats(stats);
+        usleep(STATS_INTERVAL);
+    }
+    return NULL;
+}
+
+/*
+Function: StatsType *openStats(int maxRooms)
+Purpose: Creates the STATS_SHM_NAME shared memory segment and starts the thread that publishes into it. The segment
+         keeps the ghost's dwell for room ids below maxRooms, the size is written into its header for fpstat.
+in: maxRooms - Rooms of the biggest house that will be played
+return: Returns a pointer to the new StatsType structure, or NULL if the segment can't be created
+*/
+StatsType *openStats(int maxRooms)
+{
+    size_t size = STATS_SEGMENT_SIZE(maxRooms);
+    int fd = shm_open(STATS_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        printf("Error: Failed to create shared memory segment %s\n", STATS_SHM_NAME);
+        return NULL;
+    }
+    if (ftruncate(fd, size) != 0)
+    {
+        printf("Error: Failed to size shared memory segment %s\n", STATS_SHM_NAME);
+        close(fd);
+        return NULL;
+    }
+    LiveStatsType *live = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (live == MAP_FAILED)
+    {
+        printf("Error: Failed to map shared memory segment %s\n", STATS_SHM_NAME);
+        return NULL;
+    }
+    memset(live, 0, size);
+    live->maxRooms = maxRooms;
+
+    StatsType *stats = calloc(1, sizeof(StatsType));
+    if (stats != NULL)
+    {
+        stats->roomNames = calloc(maxRooms, MAX_STR);
+        stats->roomDwell = calloc(maxRooms, sizeof(long));
+    }
+    if (stats == NULL || stats->roomNames == NULL || stats->roomDwell == NULL)
+    {
+        printf("Error allocating memory for stats\n");
+        exit(1);
+    }
+    stats->live = live;
+    stats->maxRooms = maxRooms;
+    sem_init(&stats->roomsLock, 0, 1);
+    clock_gettime(CLOCK_MONOTONIC, &stats->lastPublish);
+    stats->running = C_TRUE;
+    pthread_create(&stats->publisher, NULL, statsPublisher, stats);
+    return stats;
+}
+
+/*
+Function: void closeStats(StatsType *stats)
+Purpose: Stops the publisher after a final publish and removes the shared memory segment.
+in/out: stats - Pointer to the StatsType structure to be freed
+return: none
+*/
+void closeStats(StatsType *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    __atomic_store_n(&stats->running, C_FALSE, __ATOMIC_RELEASE);
+    pthread_join(stats->publisher, NULL);
+    publishStats(stats);
+
+    munmap(stats->live, STATS_SEGMENT_SIZE(stats->maxRooms));
+    shm_unlink(STATS_SHM_NAME);
+    sem_destroy(&stats->roomsLock);
+    free(stats->roomNames);
+    free(stats->roomDwell);
+    free(stats);
+}
+
+/*
+Function: void setStatsRooms(StatsType *stats, HouseType *house)
+Purpose: Labels the ghost dwell counters, which are kept by room id, with the names of a house's rooms. A label is set
+         by the first house that has the room and left alone after that, unless a later house names the room
+         differently (e.g. the default house and a generated one), in which case the room is labelled by its id. A
+         house with more rooms than the segment has room for is remembered, so fpstat can say what wasn't counted.
+in/out: stats - Pointer to the StatsType structure
+in: house - Pointer to the HouseType structure being played
+return: none
+*/
+void setStatsRooms(StatsType *stats, HouseType *house)
+{
+    int numRooms = house->index->numRooms < stats->maxRooms ? house->index->numRooms : stats->maxRooms;
+    sem_wait(&stats->roomsLock);
+    stats->roomsPlayed = house->index->numRooms > stats->roomsPlayed ? house->index->numRooms : stats->roomsPlayed;
+    for (int i = 0; i < numRooms; i++)
+    {
+        const char *name = house->index->rooms[i]->name;
+        if (i >= stats->numRooms)
+        {
+            strcpy(stats->roomNames[i], name);
+        }
+        else if (strcmp(stats->roomNames[i], name) != 0)
+        {
+            snprintf(stats->roomNames[i], MAX_STR, "Room id %d", i);
+        }
+    }
+    stats->numRooms = numRooms > stats->numRooms ? numRooms : stats->numRooms;
+    sem_post(&stats->roomsLock);
+}
+
+/*
+Function: void countUpdate(StatsType *stats)
+Purpose: Counts one ghost or hunter update.
+in/out: stats - Pointer to the StatsType structure, NULL if stats are disabled
+return: none
+*/
+void countUpdate(StatsType *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    __atomic_fetch_add(&stats->updates, 1, __ATOMIC_RELAXED);
+}
+
+/*
+Function: void countGhostDwell(StatsType *stats, RoomType *room)
+Purpose: Counts one ghost update spent in a room.
+in/out: stats - Pointer to the StatsType structure, NULL if stats are disabled
+in: room - Pointer to the RoomType structure the ghost is in, not counted if its id is past the segment's rooms
+return: none
+*/
+void countGhostDwell(StatsType *stats, RoomType *room)
+{
+    if (stats == NULL || room->id < 0 || room->id >= stats->maxRooms)
+    {
+        return;
+    }
+    __atomic_fetch_add(&stats->roomDwell[room->id], 1, __ATOMIC_RELAXED);
+}
+
+/*
+Function: void countEvidence(StatsType *stats)
+Purpose: Counts one piece of evidence collected by a hunter.
+in/out: stats - Pointer to the StatsType structure, NULL if stats are disabled
+return: none
+*/
+void countEvidence(StatsType *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    __atomic_fetch_add(&stats->evidenceCollected, 1, __ATOMIC_RELAXED);
+}
+
+/*
+Function: void countActiveHunters(StatsType *stats, int change)
+Purpose: Adjusts the number of hunter threads still in the house.
+in/out: stats - Pointer to the StatsType structure, NULL if stats are disabled
+in: change - Number of hunters that entered, negative for hunters that left
+return: none
+*/
+void countActiveHunters(StatsType *stats, int change)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    __atomic_fetch_add(&stats->activeHunters, change, __ATOMIC_RELAXED);
+}
+
+/*
+Function: void recordGame(StatsType *stats, GameResult result)
+Purpose: Counts a finished game and how it ended.
+in/out: stats - Pointer to the StatsType structure, NULL if stats are disabled
+in: result - How the game ended
+return: none
+*/
+void recordGame(StatsType *stats, GameResult result)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    __atomic_fetch_add(&stats->wins[result], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->gamesCompleted, 1, __ATOMIC_RELAXED);
+}
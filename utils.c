@@ -1,14 +1,55 @@
 #include "defs.h"
 
+// each thread draws from its own rand_r state
+static __thread unsigned int randomSeed = 0;
+
 /*
     Returns a pseudo randomly generated number, in the range min to (max - 1), inclusively
+    The draw is scaled in integers, a float scale can round up to max itself. Like randFloat it is one recorded draw.
         in:   lower end of the range of the generated number
         in:   upper end of the range of the generated number
-    return:   randomly generated integer in the range [0, max-1) 
+    return:   randomly generated integer in the range [min, max - 1], min if the range is empty
 */
 int randInt(int min, int max)
 {
-    return (int) randFloat(min, max);
+    if (randomSeed == 0) {
+        randomSeed = (unsigned int)time(NULL) ^ (unsigned int)pthread_self();
+    }
+
+    long long draw = recordRandom(rand_r(&randomSeed));
+    if (max <= min) {
+        return min;
+    }
+    return min + (int)(draw * (max - min) / ((long long)RAND_MAX + 1));
+}
+
+/*
+    Seeds the calling thread's random numbers, threads that never call this seed themselves from the time
+        in:   seed to start from
+*/
+void seedRandom(unsigned int seed) {
+    // 0 is what an unseeded thread looks like
+    randomSeed = seed != 0 ? seed : 1;
+}
+
+/*
+    Swaps the calling thread's random state with an agent's, so agents sharing a thread each keep their own numbers
+        in/out:   state of the agent, receives the thread's state
+*/
+void swapRandomState(unsigned int *state) {
+    unsigned int threadState = randomSeed;
+    randomSeed = *state;
+    *state = threadState;
+}
+
+/*
+    Returns the seed an agent's thread uses in a game, spread out so agents don't draw the same numbers
+        in:   seed of the game
+        in:   agent id, GHOST_AGENT or the hunter's id
+    return:   seed for the agent
+*/
+unsigned int agentSeed(unsigned int gameSeed, int agent) {
+    return gameSeed ^ ((unsigned int)(agent + 1) * 0x9E3779B9u);
 }
 
 /*
@@ -19,12 +60,11 @@ int randInt(int min, int max)
     return:   randomly generated floating point number in the range [min, max)
 */
 float randFloat(float min, float max) {
-    static __thread unsigned int seed = 0;
-    if (seed == 0) {
-        seed = (unsigned int)time(NULL) ^ (unsigned int)pthread_self();
+    if (randomSeed == 0) {
+        randomSeed = (unsigned int)time(NULL) ^ (unsigned int)pthread_self();
     }
 
-    float random = ((float) rand_r(&seed)) / (float) RAND_MAX;
+    float random = ((float) recordRandom(rand_r(&randomSeed))) / (float) RAND_MAX;
     float diff = max - min;
     float r = random * diff;
     return min + r;
@@ -91,26 +131,18 @@ void ghostToString(enum GhostClass ghost, char* buffer) {
 
 
 /*
-Function: int isHunterPresent(GhostType* ghost, HunterArrayType* list)
-Purpose: Checks if any hunter in a list is present in the same room as the specified ghost.
-in: ghost - Pointer to a GhostType structure representing the ghost
-in: list - Pointer to a HunterArrayType structure representing the list of hunters
+Function: int isHunterPresent(GhostType* ghost)
+Purpose: Checks if any hunter still in the house is in the same room as the specified ghost, from the room's occupancy
+         count, which hunters moving between rooms change in one step.
+in: ghost - Pointer to a GhostType structure representing the ghost, only the ghost's own turns move it
 return: Returns 1 if a hunter is in the same room as the ghost, 0 otherwise
 */
-int isHunterPresent(GhostType* ghost, HunterArrayType* list) {
-    if (ghost == NULL || list == NULL || list->size == 0) {
+int isHunterPresent(GhostType* ghost) {
+    if (ghost == NULL || ghost->room == NULL || ghost->room->occupancy == NULL) {
         return 0; // Equivalent to false
     }
-    //printf("isHunterPresent: %d\n", list->size);
 
-    for (int i = 0; i <= list->size; i++) {
-    
-        if (list->hunter->room == ghost->room) {
-            return 1; // Equivalent to true, a hunter is in the same room
-        }
-    }
-
-    return 0; // Equivalent to false, no hunter is in the same room
+    return countOccupants(ghost->room) > 0;
 }
 
 /*
@@ -125,7 +157,10 @@ int isGhostPresent(GhostType* ghost, HunterType *hunter) {
         return 0; // Equivalent to false
     }
 
-    if(hunter->room == ghost->room) {
+    // the ghost moves on its own thread, so its room is read through its seqlock
+    GhostViewType view;
+    readGhost(ghost, &view);
+    if(hunter->room == view.room) {
         return 1; // Equivalent to true, a ghost is in the same room
     }
 
@@ -155,7 +190,7 @@ void moveToRandomRoomGhost(GhostType *ghost) {
     for (int i = 0; i < room_num; i++) {
         connectedRooms = connectedRooms->next;
     }
-    ghost->room = connectedRooms->room; 
+    publishGhost(ghost, connectedRooms->room, ghost->boredomTime);
 
 }
 
@@ -175,9 +210,6 @@ void moveToRandomRoomHunter(HunterType *hunter, HouseType *house) {
     // Assuming hunter->room->connectedRooms is an array of RoomType pointers
     // and there is a way to indicate the end of this array (like a NULL pointer)
 
-    //remove hunter array from the old room
-    removeHunter(hunter->room->hunterArray, hunter);
-
     RoomNodeType *connectedRooms = hunter->room->roomlist->rhead;
     int numConnectedRooms = hunter->room->roomlist->size;
 
@@ -188,14 +220,57 @@ void moveToRandomRoomHunter(HunterType *hunter, HouseType *house) {
     for (int i = 0; i < room_num; i++) {
         connectedRooms = connectedRooms->next;
     }
-    hunter->room = connectedRooms->room; 
+    //move the hunter over in one step, it is never in neither room
+    moveOccupant(hunter, connectedRooms->room, house->hunterArray->hunter);
 
-    //edit hunter array in room to add hunter
-    addHunter(connectedRooms->room->hunterArray, hunter);
+}
+
+
+
+/*
+Function: void moveToFrontierRoomHunter(HunterType *hunter, HouseType *house)
+Purpose: Moves a hunter one room closer to the nearest room it hasn't visited, using the house's room index. A
+         hunter that hasn't searched its own room yet stays in it.
+in/out: hunter - Pointer to a HunterType structure representing the hunter to be moved
+in: house - Pointer to a HouseType structure representing the house environment
+*/
+void moveToFrontierRoomHunter(HunterType *hunter, HouseType *house) {
+    if (hunter == NULL || hunter->room == NULL || house == NULL || house->index == NULL) {
+        printf("Error: Null hunter, hunter room or room index reference\n");
+        return;
+    }
 
+    RoomType *next = chooseFrontierRoom(house->index, hunter);
+    if (next != hunter->room) {
+        //move the hunter over in one step, it is never in neither room
+        moveOccupant(hunter, next, house->hunterArray->hunter);
+    }
 }
 
+/*
+Function: void moveToEvidenceRoomHunter(HunterType *hunter, HouseType *house, long now)
+Purpose: Moves a hunter one room closer to the nearest room holding the evidence its equipment finds, found through
+         the house's evidence index. A hunter already in such a room stays to pick it up, and one with nothing to
+         track moves to a random connected room.
+in/out: hunter - Pointer to a HunterType structure representing the hunter to be moved
+in: house - Pointer to a HouseType structure representing the house environment
+in: now - The current virtual time in ghost updates, faded evidence isn't tracked
+*/
+void moveToEvidenceRoomHunter(HunterType *hunter, HouseType *house, long now) {
+    if (hunter == NULL || hunter->room == NULL || house == NULL || house->index == NULL || house->evidenceIndex == NULL) {
+        printf("Error: Null hunter, hunter room or house index reference\n");
+        return;
+    }
 
+    RoomType *next = chooseEvidenceRoom(house->index, house->evidenceIndex, hunter, now);
+    if (next == NULL) {
+        moveToRandomRoomHunter(hunter, house);
+    }
+    else if (next != hunter->room) {
+        //move the hunter over in one step, it is never in neither room
+        moveOccupant(hunter, next, house->hunterArray->hunter);
+    }
+}
 
 /*
 Function: RoomType* getRandomRoomExcludeVan(HouseType *house)
@@ -0,0 +1,97 @@
+#include "defs.h"
+
+/*
+Function: void initTimerWheel(TimerWheelType *wheel)
+Purpose: Initializes an empty timer wheel at tick 0.
+in/out: wheel - Pointer to the TimerWheelType structure to be initialized
+return: none
+*/
+void initTimerWheel(TimerWheelType *wheel)
+{
+    memset(wheel->slots, 0, sizeof(wheel->slots));
+    wheel->now = 0;
+    wheel->numTimers = 0;
+}
+
+/*
+Function: void placeTimer(TimerWheelType *wheel, AgentType *agent)
+Purpose: Puts an agent in the slot its expiry falls in, on the lowest level whose span still covers it.
+in/out: wheel - Pointer to the TimerWheelType structure
+in/out: agent - Pointer to the AgentType structure, its expiry is already set
+return: none
+*/
+static void placeTimer(TimerWheelType *wheel, AgentType *agent)
+{
+    long delta = agent->expires - wheel->now;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= 1L << (WHEEL_BITS * (level + 1)))
+    {
+        level++;
+    }
+    AgentType **slot = &wheel->slots[level][(agent->expires >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+    agent->next = *slot;
+    *slot = agent;
+}
+
+/*
+Function: void addTimer(TimerWheelType *wheel, AgentType *agent, long delay)
+Purpose: Wakes an agent up delay ticks from now, in O(1).
+in/out: wheel - Pointer to the TimerWheelType structure
+in/out: agent - Pointer to the AgentType structure to wake up
+in: delay - Ticks until it wakes, at least 1 and clamped to what the wheel spans
+return: none
+*/
+void addTimer(TimerWheelType *wheel, AgentType *agent, long delay)
+{
+    if (delay < 1)
+    {
+        delay = 1;
+    }
+    if (delay >= 1L << (WHEEL_BITS * WHEEL_LEVELS))
+    {
+        delay = (1L << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+    }
+    agent->expires = wheel->now + delay;
+    placeTimer(wheel, agent);
+    wheel->numTimers++;
+}
+
+/*
+Function: AgentType *advanceTimerWheel(TimerWheelType *wheel)
+Purpose: Moves the wheel on one tick and hands back every agent that wakes up in it as one batch.
+         Each time a level comes round, the next slot of the level above is spread over the levels below.
+in/out: wheel - Pointer to the TimerWheelType structure
+return: Returns the list of agents waking up in the new tick, linked through next, or NULL if there are none
+*/
+AgentType *advanceTimerWheel(TimerWheelType *wheel)
+{
+    wheel->now++;
+
+    // the higher levels are cascaded first, what they let go of may land in a slot of a lower level that is due now
+    int levels = 1;
+    while (levels < WHEEL_LEVELS && (wheel->now & ((1L << (WHEEL_BITS * levels)) - 1)) == 0)
+    {
+        levels++;
+    }
+    for (int level = levels - 1; level > 0; level--)
+    {
+        AgentType **slot = &wheel->slots[level][(wheel->now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+        AgentType *agent = *slot;
+        *slot = NULL;
+        while (agent != NULL)
+        {
+            AgentType *next = agent->next;
+            placeTimer(wheel, agent);
+            agent = next;
+        }
+    }
+
+    AgentType **slot = &wheel->slots[0][wheel->now & (WHEEL_SLOTS - 1)];
+    AgentType *ready = *slot;
+    *slot = NULL;
+    for (AgentType *agent = ready; agent != NULL; agent = agent->next)
+    {
+        wheel->numTimers--;
+    }
+    return ready;
+}